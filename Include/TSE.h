@@ -172,6 +172,42 @@ extern CUniverse *g_pUniverse;
 
 //	CResourceDb
 
+class CGameFileCache
+	{
+	public:
+		CGameFileCache (void) : m_pFile(NULL), m_bModified(false) { }
+		~CGameFileCache (void) { CleanUp(); }
+
+		void Add (const CString &sEntry, CXMLElement *pXML);
+		void CleanUp (void);
+		bool Find (const CString &sEntry, CXMLElement **retpXML);
+		inline bool IsModified (void) const { return m_bModified; }
+		ALERROR Open (const CString &sFilespec, const CIntegerIP &Digest);
+		ALERROR Save (CString *retsError = NULL);
+
+	private:
+		struct SEntry
+			{
+			SEntry (void) : iOffset(0), iLength(0) { }
+
+			int iOffset;					//	Offset in m_pFile (if iLength > 0)
+			int iLength;
+			CString sData;					//	New entry (not yet saved)
+			};
+
+		static bool ReadDWORD (char **iopPos, char *pEnd, DWORD *retdwValue);
+		static bool ReadElement (char **iopPos, char *pEnd, CXMLElement *pParent, CXMLElement **retpXML);
+		static bool ReadString (char **iopPos, char *pEnd, CString *retsValue);
+		static void WriteElement (CMemoryWriteStream &Stream, CXMLElement *pXML);
+		static void WriteString (CMemoryWriteStream &Stream, const CString &sValue);
+
+		CString m_sFilespec;				//	Cache file
+		CIntegerIP m_Digest;				//	Digest of source file
+		CFileReadBlock *m_pFile;			//	Mapped cache file (may be NULL)
+		TSortMap<CString, SEntry> m_Entries;
+		bool m_bModified;					//	TRUE if we have entries to save
+	};
+
 class CResourceDb
 	{
 	public:
@@ -192,7 +228,9 @@ class CResourceDb
 		ALERROR LoadModule (const CString &sFolder, const CString &sFilename, CXMLElement **retpData, CString *retsError);
 		ALERROR LoadSound (CSoundMgr &SoundMgr, const CString &sFolder, const CString &sFilename, int *retiChannel);
 		ALERROR Open (DWORD dwFlags, CString *retsError);
+		void OpenCache (const CString &sCacheFilespec, const CIntegerIP &Digest);
 		CString ResolveFilespec (const CString &sFolder, const CString &sFilename) const;
+		ALERROR SaveCache (void);
 		void SetEntities (IXMLParserController *pEntities, bool bFree = false);
 
 		CString GetResourceFilespec (int iIndex);
@@ -234,6 +272,10 @@ class CResourceDb
 
 		IXMLParserController *m_pEntities;			//	Entities to use in parsing
 		bool m_bFreeEntities;						//	If TRUE, we own m_pEntities;
+
+		//	Parsed XML cache (only for self-contained TDB files)
+		CGameFileCache *m_pCache;
+		bool m_bCacheModules;						//	TRUE if modules may be cached
 	};
 
 class CAStarPathFinder
@@ -313,6 +355,7 @@ void DrawParticle (CG16bitImage &Dest,
 				   WORD wColor,
 				   int iSize,
 				   DWORD byOpacity);
+ALERROR WriteImageAsBMP (CG16bitImage &Image, const CString &sFilespec, CString *retsError = NULL);
 
 //	Helper functions
 
@@ -683,6 +726,15 @@ class CSystemCreateStats
 			TProbabilityTable<CStationType *> Table;
 			};
 
+		struct SSystemCreateTime
+			{
+			CString sNodeID;
+			CString sSystemName;
+			int iLevel;
+			int iObjCount;					//	Objects in system after creation
+			DWORD dwTime;					//	Time to create (milliseconds)
+			};
+
 		CSystemCreateStats (void);
 		~CSystemCreateStats (void);
 
@@ -690,12 +742,16 @@ class CSystemCreateStats
 		void AddFillLocationsTable (CSystem *pSystem, const TProbabilityTable<int> &LocationTable, const CString &sStationCriteria);
 		inline void AddPermuteAttrib (const CString &sAttrib) { m_PermuteAttribs.Insert(sAttrib); }
 		void AddStationTable (CSystem *pSystem, const CString &sStationCriteria, const CString &sLocationAttribs, TArray<CStationTableCache::SEntry> &Table);
+		void AddSystemCreateTime (CSystem *pSystem, DWORD dwTime);
 		inline const SEncounterTable &GetEncounterTable (int iIndex) const { return m_EncounterTables[iIndex]; }
 		inline int GetEncounterTableCount (void) const { return m_EncounterTables.GetCount(); }
 		inline const SFillLocationsTable &GetFillLocationsTable (int iIndex) const { return m_FillLocationsTables[iIndex]; }
 		inline int GetFillLocationsTableCount (void) const { return m_FillLocationsTables.GetCount(); }
 		inline int GetLabelAttributesCount (void) { return m_LabelAttributeCounts.GetCount(); }
 		void GetLabelAttributes (int iIndex, CString *retsAttribs, int *retiCount);
+		inline const SSystemCreateTime &GetSystemCreateTime (int iIndex) const { return m_SystemCreateTimes[iIndex]; }
+		inline int GetSystemCreateTimeCount (void) const { return m_SystemCreateTimes.GetCount(); }
+		DWORD GetTotalCreateTime (void) const;
 		inline int GetTotalLabelCount (void) { return m_iLabelCount; }
 		inline void SetPermute (bool bValue = true) { m_bPermute = bValue; }
 
@@ -723,6 +779,10 @@ class CSystemCreateStats
 
 		TArray<SEncounterTable> m_EncounterTables;
 		TArray<SFillLocationsTable> m_FillLocationsTables;
+
+		//	Timing
+
+		TArray<SSystemCreateTime> m_SystemCreateTimes;
 	};
 
 class CSystemCreateEvents
@@ -742,6 +802,59 @@ class CSystemCreateEvents
 		TArray<SEventDesc> m_Events;
 	};
 
+//	CSystemCreateGrid is a spatial hash of objects and locations that we
+//	maintain while a system is being created, so that placement checks
+//	(exclusion zones, overlaps, etc.) only need to look at nearby cells.
+
+class CSystemCreateGrid
+	{
+	public:
+		enum Flags
+			{
+			//	GetObjectsInRange
+			FLAG_STRUCTURES_ONLY =			0x00000001,	//	Only return structure-scale objects
+			FLAG_ADD_EXCLUSION_RADIUS =		0x00000002,	//	Expand range by largest exclusion radius
+			FLAG_ADD_BOUNDS =				0x00000004,	//	Expand range by largest object bounds
+			};
+
+		CSystemCreateGrid (void);
+
+		void AddObject (int iIndex);
+		void CleanUp (void);
+		void GetLocationsInRange (CSystem *pSystem, const CVector &vPos, Metric rRange, TArray<int> *retList);
+		void GetObjectsInRange (CSystem *pSystem, const CVector &vPos, Metric rRange, DWORD dwFlags, TArray<CSpaceObject *> *retList);
+		void Init (CSystem *pSystem);
+		inline bool IsActive (void) const { return m_bActive; }
+
+	private:
+		struct SObjEntry
+			{
+			int iIndex;						//	Index of object in system
+			CSpaceObject *pObj;				//	Object (to detect reused slots)
+			bool bStructure;				//	TRUE if structure-scale object
+			};
+
+		struct SCell
+			{
+			TArray<SObjEntry> Objs;
+			TArray<int> Locations;
+			};
+
+		void GetCellRange (const CVector &vPos, Metric rRange, int *retxLL, int *retyLL, int *retxUR, int *retyUR) const;
+		void GetCellsInRange (const CVector &vPos, Metric rRange, TArray<SCell *> *retList);
+		inline DWORD GetCellKey (int x, int y) const { return MAKELONG((WORD)(short)x, (WORD)(short)y); }
+		SCell *SetCell (const CVector &vPos);
+		void Sync (CSystem *pSystem);
+
+		bool m_bActive;						//	TRUE if we're creating a system
+		TSortMap<DWORD, SCell> m_Cells;		//	Cells (indexed by packed x,y)
+		TArray<int> m_PendingObjs;			//	Objects added but not yet indexed
+		int m_iLocationsIndexed;			//	Locations [0..m_iLocationsIndexed) are indexed
+
+		Metric m_rMaxBounds;				//	Largest bounds radius of all indexed objects
+		Metric m_rMaxExclusion;				//	Largest exclusion radius of all indexed structures
+	};
+
 struct SLocationCriteria
 	{
 	SLocationCriteria (void) :
@@ -793,12 +906,14 @@ struct SSystemUpdateCtx
 	{
 	SSystemUpdateCtx (void) : rSecondsPerTick(g_SecondsPerUpdate),
 			bForceEventFiring(false),
-			bForcePainted(false)
+			bForcePainted(false),
+			bCatchUp(false)
 		{ }
 
 	Metric rSecondsPerTick;
 	bool bForceEventFiring;					//	If TRUE, fire events even if no player ship
 	bool bForcePainted;						//	If TRUE, mark objects as painted 
+	bool bCatchUp;							//	If TRUE, reduced-fidelity update (see UpdateExtended)
 	};
 
 //	CMoveCtx is currently unused; it was part of an experiment to see
@@ -1016,7 +1131,17 @@ class CEnvironmentGrid
 			tileSizeCompatible =			512,	//	Tile size in pixels (pre version 88, when we stored it)
 			};
 
+		struct SVisibleTile
+			{
+			int x;
+			int y;
+			CSpaceEnvironmentType *pEnv;
+			DWORD dwEdgeMask;
+			CVector vCenter;				//	Center of tile
+			};
+
 		DWORD AddEdgeFlag (DWORD dwTile, DWORD dwEdgeFlag) const;
+		void CalcVisibleTiles (int x1, int y1, int x2, int y2);
 		void ConvertSpaceEnvironmentToPointers (CTileMap &UNIDs);
 		CSpaceEnvironmentType *GetSpaceEnvironmentFromTileDWORD (DWORD dwTile) const;
 		inline bool InBounds (int xTile, int yTile) const { return (xTile >= 0 && xTile < m_iTileCount && yTile >= 0 && yTile <= m_iTileCount); }
@@ -1026,6 +1151,10 @@ class CEnvironmentGrid
 		TSortMap<CSpaceEnvironmentType *, bool> m_EnvList;
 		int m_iTileSize;					//	Size of tile (in pixels)
 		int m_iTileCount;					//	Size of grid in tiles
+
+		TArray<SVisibleTile> m_VisibleTiles;	//	Non-empty tiles in m_rcVisibleTiles
+		RECT m_rcVisibleTiles;				//	Tile range (inclusive) of m_VisibleTiles
+		bool m_bVisibleTilesValid;			//	If FALSE, m_VisibleTiles must be recomputed
 	};
 
 class CMapGridPainter
@@ -1227,6 +1356,7 @@ class CSystem : public CObject
 		void FireOnSystemObjDestroyed (SDestroyCtx &Ctx);
 		void FireOnSystemWeaponFire (CSpaceObject *pShot, CWeaponFireDesc *pDesc, const CDamageSource &Source);
 		CString GetAttribsAtPos (const CVector &vPos);
+		inline CSystemCreateGrid &GetCreateGrid (void) { return m_CreateGrid; }
 		inline CSpaceObject *GetDestroyedObject (int iIndex) { return m_DeletedObjects.GetObj(iIndex); }
 		inline int GetDestroyedObjectCount (void) { return m_DeletedObjects.GetCount(); }
 		inline CEnvironmentGrid *GetEnvironmentGrid (void) { InitSpaceEnvironment(); return m_pEnvironment; }
@@ -1260,6 +1390,7 @@ class CSystem : public CObject
 		CTopologyNode *GetStargateDestination (const CString &sStargate, CString *retsEntryPoint);
 		inline CUniverse *GetUniverse (void) const { return g_pUniverse; }
 		bool HasAttribute (const CVector &vPos, const CString &sAttrib);
+		inline bool IsCatchUpInProgress (void) const { return (m_fInCatchUp ? true : false); }
 		inline bool IsCreationInProgress (void) const { return (m_fInCreate ? true : false); }
 		inline bool IsPlayerUnderAttack (void) const { return m_fPlayerUnderAttack; }
 		bool IsStarAtPos (const CVector &vPos);
@@ -1297,7 +1428,7 @@ class CSystem : public CObject
 		void UnnameObject (CSpaceObject *pObj);
 		void UnregisterEventHandler (CSpaceObject *pObj);
 		void Update (SSystemUpdateCtx &SystemCtx);
-		void UpdateExtended (const CTimeSpan &ExtraTime);
+		void UpdateExtended (const CTimeSpan &ExtraTime, bool bFastCatchUp = false, DWORD *retdwTime = NULL);
 		void VectorToTile (const CVector &vPos, int *retx, int *rety) const;
 		void WriteObjRefToStream (CSpaceObject *pObj, IWriteStream *pStream, CSpaceObject *pReferrer = NULL);
 		void WriteSovereignRefToStream (CSovereign *pSovereign, IWriteStream *pStream);
@@ -1335,6 +1466,7 @@ class CSystem : public CObject
 		CSystem (void);
 		CSystem (CUniverse *pUniv, CTopologyNode *pTopology);
 
+		void CalcCombatObjects (TArray<bool> *retInCombat);
 		void CalcViewportCtx (SViewportPaintCtx &Ctx, const RECT &rcView, CSpaceObject *pCenter, DWORD dwFlags);
 		void ComputeMapLabels (void);
 		void ComputeRandomEncounters (void);
@@ -1352,7 +1484,8 @@ class CSystem : public CObject
 		void PaintDestinationMarker (SViewportPaintCtx &Ctx, CG16bitImage &Dest, int x, int y, CSpaceObject *pObj);
 		void PaintStarField(CG16bitImage &Dest, const RECT &rcView, CSpaceObject *pCenter, Metric rKlicksPerPixel, WORD wSpaceColor);
 		void ResetStarField (void);
-		void UpdateGravity (SUpdateCtx &Ctx, CSpaceObject *pGravityObj);
+		Metric CalcGravityRange (CSpaceObject *pGravityObj);
+		void UpdateGravity (SUpdateCtx &Ctx, CSpaceObject *pGravityObj, const CSpaceObjectList &Objs);
 		void UpdateRandomEncounters (void);
 
 		//	Game instance data
@@ -1386,16 +1519,18 @@ class CSystem : public CObject
 		DWORD m_fEnemiesInLRS:1;				//	TRUE if we found enemies in last LRS update
 		DWORD m_fEnemiesInSRS:1;				//	TRUE if we found enemies in last SRS update
 		DWORD m_fPlayerUnderAttack:1;			//	TRUE if at least one object has player as target
-		DWORD m_fSpare8:1;
+		DWORD m_fInCatchUp:1;					//	TRUE if we're in a reduced-fidelity UpdateExtended
 
 		DWORD m_fSpare:24;
 
 		//	Support structures
 
-		CStructArray m_StarField;				//	Star field
+		TArray<CStar> m_StarField;				//	Star field
 		CSpaceObjectList m_EncounterObjs;		//	List of objects that generate encounters
 		CSpaceObjectList m_BarrierObjects;		//	List of barrier objects
 		CSpaceObjectList m_GravityObjects;		//	List of objects that have gravity
+		TArray<SSpaceObjectGridQuery> m_GravityQueries;	//	Scratch grid queries for gravity (one per gravity object)
+		TArray<CSpaceObjectList> m_GravityResults;	//	Scratch results for m_GravityQueries
 		CSpaceObjectList m_Stars;				//	List of stars in the system
 		CSpaceObjectGrid m_ObjGrid;				//	Grid to help us hit test
 		CSpaceObjectList m_DeletedObjects;		//	List of objects deleted in the current update
@@ -1405,6 +1540,7 @@ class CSystem : public CObject
 		CSpaceObjectList m_ForegroundObjs;		//	List of foreground objects to paint in viewport
 		CSpaceObjectList m_DeferredOnCreate;	//	Ordered list of objects that need an OnSystemCreated call
 		CMapGridPainter m_GridPainter;			//	Structure to paint a grid
+		CSystemCreateGrid m_CreateGrid;			//	Spatial index of objects/locations while creating
 
 		static const Metric g_MetersPerKlick;
 
@@ -1547,6 +1683,8 @@ class CTopology
 		ALERROR InitComplexArea (CXMLElement *pAreaDef, int iMinRadius, CComplexArea *retArea, STopologyCreateCtx *pCtx = NULL, CTopologyNode **iopExit = NULL); 
 		void ReadFromStream (SUniverseLoadCtx &Ctx);
 
+		static inline void InvalidateDistances (void) { g_dwGateChanges++; }
+
 	private:
 		enum NodeTypes
 			{
@@ -1577,16 +1715,22 @@ class CTopology
 								 CEffectCreator *pEffect,
 								 CTopologyNode **retpNode = NULL);
 		ALERROR AddTopologyNode (const CString &sID, CTopologyNode *pNode);
+		void CalcDistancesFrom (int iSource);
 		CString ExpandNodeID (STopologyCreateCtx &Ctx, const CString &sID);
 		ALERROR FindTopologyDesc (STopologyCreateCtx &Ctx, const CString &sNodeID, CTopologyDesc **retpNode, NodeTypes *retiNodeType = NULL);
 		CString GenerateUniquePrefix (const CString &sPrefix, const CString &sTestNodeID);
 		void GetAbsoluteDisplayPos (STopologyCreateCtx &Ctx, int x, int y, int *retx, int *rety, int *retiRotation);
-		int GetDistance (CTopologyNode *pSource, const CString &sDestID, int iBestDist = -1);
 		void GetFragmentDisplayPos (STopologyCreateCtx &Ctx, CTopologyNode *pNode, int *retx, int *rety);
 		ALERROR GetOrAddTopologyNode (STopologyCreateCtx &Ctx, const CString &sID, CTopologyNode *pPrevNode, CXMLElement *pGateDesc, CTopologyNode **retpNode);
 
 		CTopologyNodeList m_Topology;
 		TSortMap<CString, int> m_IDToNode;
+
+		TArray<int> m_Distances;				//	Gates from node i to j at (i * count + j); -1 = no path
+		TArray<bool> m_DistancesValid;			//	TRUE if we've computed row i of m_Distances
+		DWORD m_dwDistancesGateChanges;			//	g_dwGateChanges when we computed m_Distances
+
+		static DWORD g_dwGateChanges;			//	Incremented whenever nodes or gates change
 	};
 
 //	Events
@@ -1603,6 +1747,7 @@ class CTimedEncounterEvent : public CTimedEvent
 
 		virtual CString DebugCrashInfo (void);
 		virtual void DoEvent (DWORD dwTick, CSystem *pSystem);
+		virtual CSpaceObject *GetObjRef (void) { return m_pTarget; }
 		virtual bool OnObjDestroyed (CSpaceObject *pObj);
 
 	protected:
@@ -1811,8 +1956,8 @@ class CItemEventDispatcher
 		CItemEventDispatcher (void);
 		~CItemEventDispatcher (void);
 
-		inline void FireEvent (CSpaceObject *pSource, ECodeChainEvents iEvent)	{ if (m_pFirstEntry) FireEventFull(pSource, iEvent); }
-		inline void FireUpdateEvents (CSpaceObject *pSource) { if (m_pFirstEntry) FireUpdateEventsFull(pSource); }
+		inline void FireEvent (CSpaceObject *pSource, ECodeChainEvents iEvent)	{ if (m_pFirstUpdate || m_pFirstAIUpdate) FireEventFull(pSource, iEvent); }
+		inline void FireUpdateEvents (CSpaceObject *pSource) { if (m_pFirstUpdate) FireUpdateEventsFull(pSource); }
 		void Init (CSpaceObject *pSource);
 
 	private:
@@ -1829,13 +1974,15 @@ class CItemEventDispatcher
 			SEntry *pNext;
 			};
 
-		void AddEntry (const CString &sEvent, EItemEventDispatchTypes iType, const SEventHandlerDesc &Event, const CItem &Item, DWORD dwEnhancementID);
-		SEntry *AddEntry (void);
+		SEntry *AddEntry (SEntry **ioFirst);
+		void AddEventEntry (SEntry **ioFirst, ECodeChainEvents iEvent, const SEventHandlerDesc &Event, const CItem &Item);
 		void FireEventFull (CSpaceObject *pSource, ECodeChainEvents iEvent);
 		void FireUpdateEventsFull (CSpaceObject *pSource);
 		void RemoveAll (void);
+		static void RemoveAll (SEntry **ioFirst);
 
-		SEntry *m_pFirstEntry;
+		SEntry *m_pFirstUpdate;							//	OnUpdate events and enhancement lifetime checks
+		SEntry *m_pFirstAIUpdate;						//	OnAIUpdate events
 	};
 
 //	Ship classes and types
@@ -2211,6 +2358,12 @@ class CSpaceObject : public CObject
 		virtual ~CSpaceObject (void);
 		static void CreateFromStream (SLoadCtx &Ctx, CSpaceObject **retpObj);
 
+		//	Since the destructor is virtual, delete gets the size of the
+		//	derived class.
+
+		inline void *operator new (size_t iSize) { CMemoryStats::Alloc(CMemoryStats::tagSpaceObjects, (int)iSize); return ::operator new(iSize); }
+		inline void operator delete (void *pObj, size_t iSize) { CMemoryStats::Free(CMemoryStats::tagSpaceObjects, (int)iSize); ::operator delete(pObj); }
+
 		void Accelerate (const CVector &vPush, Metric rSeconds);
 		void AccelerateStop (Metric rPush, Metric rSeconds);
 		void AddEffect (IEffectPainter *pPainter, const CVector &vPos, int iTick = 0, int iRotation = 0);
@@ -2228,6 +2381,7 @@ class CSpaceObject : public CObject
 		bool CanDetect (int Perception, CSpaceObject *pObj);
 		bool CanCommunicateWith (CSpaceObject *pSender);
 		inline bool CanHitFriends (void) { return !m_fNoFriendlyFire; }
+		inline void ClearPainted (void) { m_fPainted = false; }
 		inline void ClearPaintNeeded (void) { m_fPaintNeeded = false; }
 		inline void ClearPlayerDestination (void) { m_fPlayerDestination = false; m_fAutoClearDestination = false; m_fAutoClearDestinationOnDock = false; m_fAutoClearDestinationOnDestroy = false; m_fShowDistanceAndBearing = false; m_fShowHighlight = false; }
 		inline void ClearPlayerDocked (void) { m_fPlayerDocked = false; }
@@ -2807,13 +2961,13 @@ class CSpaceObject : public CObject
 		inline void ClearInDamageCode (void) { m_fInDamage = false; }
 		inline void ClearInUpdateCode (void) { m_pObjInUpdate = NULL; m_bObjDestroyed = false; }
 		inline void ClearObjReferences (void) { m_Data.OnSystemChanged(NULL); }
-		inline void ClearPainted (void) { m_fPainted = false; }
 		inline void DisableObjectDestructionNotify (void) { m_fNoObjectDestructionNotify = true; }
 		inline const Metric &GetBounds (void) { return m_rBoundsX; }
 		CSpaceObject *HitTest (const CVector &vStart, Metric rThreshold, const DamageDesc &Damage, CVector *retvHitPos, int *retiHitDir);
 		bool ImagesIntersect (const CObjectImageArray &Image1, int iTick1, int iRotation1, const CVector &vPos1,
 				const CObjectImageArray &Image2, int iTick2, int iRotation2, const CVector &vPos2);
 		inline bool IsObjectDestructionHooked (void) { return (m_fHookObjectDestruction ? true : false); }
+		inline bool NeedsObjDestroyedNotify (void) { return (m_fHookObjectDestruction || m_Data.HasObjRefData() || m_SubscribedObjs.GetCount() > 0); }
 		inline void ItemEnhancementModified (CItemListManipulator &ItemList) { OnItemEnhanced(ItemList); }
 		bool MissileCanHitObj (CSpaceObject *pObj, CSpaceObject *pSource, CWeaponFireDesc *pDesc);
 		void PaintEffects (CG16bitImage &Dest, int x, int y, SViewportPaintCtx &Ctx);
@@ -3019,16 +3173,33 @@ class CObjectTracker
 			{
 			CTopologyNode *pNode;
 			CDesignType *pType;
+			int iType;						//	Index into m_Types
 			TArray<DWORD> ObjectIDs;
 			TSortMap<DWORD, SObjName> ObjectNames;
 			};
 
+		struct SAttribIndex
+			{
+			SAttribIndex (void) : iTypesChecked(0) { }
+
+			int iTypesChecked;				//	m_Types[0..iTypesChecked) are in Types
+			TArray<int> Types;				//	Indices of types with the attribute
+			};
+
 		bool AccumulateEntries (TArray<SObjList *> &Table, const CDesignTypeCriteria &Criteria, TArray<SObjEntry> *retResult);
+		void AddEntries (SObjList *pList, TArray<SObjEntry> *retResult);
+		bool FindAll (const CDesignTypeCriteria &Criteria, TArray<SObjEntry> *retResult);
 		SObjList *GetList (CSpaceObject *pObj);
 		SObjList *GetList (CTopologyNode *pNode, CDesignType *pType);
+		int GetTypeIndex (CDesignType *pType);
+		const TArray<int> &GetTypesWithAttribute (const CString &sAttrib);
 
 		TArray<SObjList *> m_AllLists;
 		TSortMap<CString, TArray<SObjList *>> m_ByNode;
+
+		TArray<CDesignType *> m_Types;		//	All types that we track (in order added)
+		TSortMap<DWORD, int> m_TypeIndex;	//	Index into m_Types by UNID
+		TSortMap<CString, SAttribIndex> m_ByAttrib;	//	Types by literal attribute (computed on demand)
 	};
 
 class CObjectStats
@@ -3304,6 +3475,7 @@ class CUniverse : public CObject
 		const CDamageAdjDesc *GetShieldDamageAdj (int iLevel) const;
 		inline CSoundMgr *GetSoundMgr (void) { return m_pSoundMgr; }
 		DWORD GetSoundUNID (int iChannel);
+		inline DWORD GetLastCatchUpTime (void) const { return m_dwLastCatchUpTime; }
 		inline bool InDebugMode (void) { return m_bDebugMode; }
 		inline void InitEntityResolver (CExtension *pExtension, CEntityResolverList *retResolver) { m_Extensions.InitEntityResolver(pExtension, (InDebugMode() ? CExtensionCollection::FLAG_DEBUG_MODE : 0), retResolver); }
 		inline bool InResurrectMode (void) { return m_bResurrectMode; }
@@ -3313,6 +3485,7 @@ class CUniverse : public CObject
 		ALERROR LoadFromStream (IReadStream *pStream, DWORD *retdwSystemID, DWORD *retdwPlayerID, CString *retsError);
 		inline ALERROR LoadNewExtension (const CString &sFilespec, const CIntegerIP &FileDigest, CString *retsError) { return m_Extensions.LoadNewExtension(sFilespec, FileDigest, retsError); }
 		inline bool LogImageLoad (void) const { return (m_iLogImageLoad == 0); }
+		inline void OnMissionOwnerChanged (CMission *pMission, DWORD dwOldOwnerID) { m_AllMissions.OnOwnerChanged(pMission, dwOldOwnerID); }
 		void PlaySound (CSpaceObject *pSource, int iChannel);
 		void PutPlayerInSystem (CShip *pPlayerShip, const CVector &vPos, CTimedEventList &SavedEvents);
 		void RefreshCurrentMission (void);
@@ -3322,6 +3495,7 @@ class CUniverse : public CObject
 		ALERROR SaveToStream (IWriteStream *pStream);
 		void SetCurrentSystem (CSystem *pSystem);
 		inline void SetDebugMode (bool bDebug = true) { m_bDebugMode = bDebug; }
+		inline void SetFastCatchUp (bool bEnabled = true) { m_bFastCatchUp = bEnabled; }
 		bool SetExtensionData (EStorageScopes iScope, DWORD dwExtension, const CString &sAttrib, const CString &sData);
 		void SetNewSystem (CSystem *pSystem, CShip *pPlayerShip, CSpaceObject *pPOV);
 		void SetPOV (CSpaceObject *pPOV);
@@ -3372,13 +3546,22 @@ class CUniverse : public CObject
 		CSovereign *GetPlayerSovereign (void) const;
 		inline int GetTicks (void) { return m_iTick; }
 
+		inline void AddImageLoadStall (void) { m_iImageLoadStalls++; }
+		inline void AddItemEventRebuild (void) { m_iItemEventRebuilds++; }
+		inline void AddObjDestroyedNotify (void) { m_iObjDestroyedNotifies++; }
 		inline void ClearLibraryBitmapMarks (void) { m_Design.ClearImageMarks(); }
+		bool DeferImageLoad (CObjectImage *pImage);
 		void GarbageCollectLibraryBitmaps (void);
 		inline CObjectImage *FindLibraryImage (DWORD dwUNID) { return CObjectImage::AsType(m_Design.FindEntry(dwUNID)); }
+		inline int GetImageLoadStalls (void) const { return m_iImageLoadStalls; }
+		inline int GetItemEventRebuilds (void) const { return m_iLastItemEventRebuilds; }
+		inline int GetObjDestroyedNotifies (void) const { return m_iLastObjDestroyedNotifies; }
 		inline CG16bitImage *GetLibraryBitmap (DWORD dwUNID, DWORD dwFlags = 0) { return m_Design.GetImage(dwUNID, dwFlags); }
 		inline CG16bitImage *GetLibraryBitmapCopy (DWORD dwUNID) { return m_Design.GetImage(dwUNID, CDesignCollection::FLAG_IMAGE_COPY); }
-		inline void MarkLibraryBitmaps (void) { m_Design.MarkGlobalImages(); if (m_pCurrentSystem) m_pCurrentSystem->MarkImages(); }
+		inline bool IsPrefetchingImages (void) const { return m_bPrefetchingImages; }
+		void MarkLibraryBitmaps (void);
 		inline void ReleaseLibraryBitmap (CG16bitImage *pBitmap) { }
+		inline void ResetImageLoadStalls (void) { m_iImageLoadStalls = 0; }
 		inline void SweepLibraryBitmaps (void) { m_Extensions.SweepImages(); m_Design.SweepImages(); }
 
 		inline CDesignCollection &GetDesignCollection (void) { return m_Design; }
@@ -3403,6 +3586,7 @@ class CUniverse : public CObject
 		inline int GetTopologyNodeCount (void) { return m_Topology.GetTopologyNodeCount(); }
 
 		void PaintPOV (CG16bitImage &Dest, const RECT &rcView, DWORD dwFlags);
+		ALERROR PaintPOVToFile (const CString &sFilespec, int cxWidth, int cyHeight, DWORD dwFlags, CString *retsError = NULL);
 		void PaintPOVLRS (CG16bitImage &Dest, const RECT &rcView, bool *retbNewEnemies);
 		void PaintPOVMap (CG16bitImage &Dest, const RECT &rcView, Metric rMapScale);
 		void PaintObject (CG16bitImage &Dest, const RECT &rcView, CSpaceObject *pObj);
@@ -3431,6 +3615,8 @@ class CUniverse : public CObject
 			STransSystemObject *pNext;
 			};
 
+		void BeginImagePrefetch (void);
+		void EndImagePrefetch (void);
 		bool FindByUNID (CIDTable &Table, DWORD dwUNID, CObject **retpObj = NULL);
 		CObject *FindByUNID (CIDTable &Table, DWORD dwUNID);
 		IShipController *GetPlayerController (void) const;
@@ -3489,10 +3675,26 @@ class CUniverse : public CObject
 		const CG16bitFont *m_FontTable[fontCount];
 		CG16bitFont m_DefaultFonts[fontCount];
 
+		//	Image prefetch
+
+		TArray<CObjectImage *> m_ImagePrefetch;	//	Images marked while deferring loads
+		int m_iDeferImageLoad;					//	If >0 CObjectImage::Mark defers loads
+		bool m_bPrefetchingImages;				//	TRUE while helper threads load images
+		int m_iImageLoadStalls;					//	Images loaded synchronously during play
+
+		//	Performance counters
+
+		int m_iItemEventRebuilds;				//	Item event dispatchers rebuilt this tick
+		int m_iLastItemEventRebuilds;			//	Item event dispatchers rebuilt last tick
+		int m_iObjDestroyedNotifies;			//	OnObjDestroyed calls this tick
+		int m_iLastObjDestroyedNotifies;		//	OnObjDestroyed calls last tick
+
 		//	Debugging structures
 
 		bool m_bDebugMode;
 		bool m_bNoSound;
+		bool m_bFastCatchUp;					//	If TRUE, use reduced-fidelity UpdateExtended (off unless the host opts in)
+		DWORD m_dwLastCatchUpTime;				//	Time spent in last UpdateExtended (ms)
 		int m_iLogImageLoad;					//	If >0 we disable image load logging
 	};
 
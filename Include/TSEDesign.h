@@ -104,7 +104,9 @@ struct CItemCriteria
 
 	CItemCriteria &operator= (const CItemCriteria &Copy);
 
+	inline void ClearCache (void) const { TypeMatches.DeleteAll(); dwTypeMatchesGeneration = 0; }
 	int GetMaxLevelMatched (void) const;
+	bool MatchesItemType (CItemType *pType) const;
 
 	DWORD dwItemCategories;			//	Set of ItemCategories to match on
 	DWORD dwExcludeCategories;		//	Categories to exclude
@@ -136,6 +138,12 @@ struct CItemCriteria
 	int iLessThanMass;				//	If not -1, only items less than this mass (in kg)
 
 	ICCItem *pFilter;				//	Filter returns Nil for excluded items
+
+	//	Results of the parts of the criteria that only depend on the item type
+	//	(cached by item type UNID until the design collection changes).
+
+	mutable TSortMap<DWORD, bool> TypeMatches;
+	mutable DWORD dwTypeMatchesGeneration;
 	};
 
 enum EDisplayAttributeTypes
@@ -820,6 +828,14 @@ struct SPointInObjectCtx
 class CObjectImage : public CDesignType
 	{
 	public:
+		struct SPrefetch
+			{
+			CString sResourceDb;		//	These are private copies because
+			CString sBitmap;			//		helper threads must not share
+			CString sBitmask;			//		string storage with the main thread.
+			bool bExternalDb;			//	TRUE if not the universe's resource db
+			};
+
 		CObjectImage (void);
 		CObjectImage (CG16bitImage *pBitmap, bool bFreeBitmap = false);
 		~CObjectImage (void);
@@ -829,11 +845,14 @@ class CObjectImage : public CDesignType
 		CG16bitImage *GetImage (const CString &sLoadReason, CString *retsError = NULL);
 		CG16bitImage *GetImage (CResourceDb &ResDb, const CString &sLoadReason, CString *retsError = NULL);
 		inline CString GetImageFilename (void) { return m_sBitmap; }
+		const CImageMask *GetMask (void);
 		inline bool HasAlpha (void) { return (m_pBitmap ? m_pBitmap->HasAlpha() : false); }
 
 		inline void ClearMark (void) { m_bMarked = false; }
 		ALERROR Lock (SDesignLoadCtx &Ctx);
-		inline void Mark (void) { GetImage(NULL_STR); m_bMarked = true; }
+		void InitPrefetch (SPrefetch *retPrefetch);
+		void Mark (void);
+		void Prefetch (const SPrefetch &Prefetch);
 		void Sweep (void);
 
 		//	CDesignType overrides
@@ -848,6 +867,8 @@ class CObjectImage : public CDesignType
 		virtual void OnUnbindDesign (void);
 
 	private:
+		CG16bitImage *LoadBitmap (CResourceDb &ResDb, const CString &sBitmap, const CString &sBitmask, CString *retsError);
+
 		CString m_sResourceDb;			//	Resource db
 		CString m_sBitmap;				//	Bitmap resource within db
 		CString m_sBitmask;				//	Bitmask resource within db
@@ -859,8 +880,10 @@ class CObjectImage : public CDesignType
 		bool m_bFreeBitmap;				//	If TRUE, we free the bitmap when done
 
 		CG16bitImage *m_pBitmap;		//	Loaded image (NULL if not loaded)
+		CImageMask *m_pMask;			//	Hit test mask (NULL if not yet computed)
 		bool m_bMarked;					//	Marked
 		bool m_bLocked;					//	Image is never unloaded
+		bool m_bPrefetchPending;		//	Queued for load by CUniverse (see Mark)
 	};
 
 class CObjectImageArray : public CObject
@@ -1710,6 +1733,7 @@ class CItemEnhancementStack
 		void ApplySpecialDamage (DamageDesc *pDamage) const;
 		int CalcActivateDelay (CItemCtx &DeviceCtx) const;
 		void Delete (void);
+		inline void DeleteAll (void) { m_Stack.DeleteAll(); m_bCacheValid = false; }
 		int GetBonus (void) const;
 		inline int GetCount (void) const { return m_Stack.GetCount(); }
 		const DamageDesc &GetDamage (void) const;
@@ -1717,6 +1741,7 @@ class CItemEnhancementStack
 		void InsertActivateAdj (int iAdj, int iMin, int iMax);
 		void InsertHPBonus (int iBonus);
 		inline bool IsEmpty (void) const { return (m_Stack.GetCount() == 0); }
+		bool IsEqual (const CItemEnhancementStack &Stack) const;
 
 		static void ReadFromStream (SLoadCtx &Ctx, CItemEnhancementStack **retpStack);
 		static void WriteToStream (CItemEnhancementStack *pStack, IWriteStream *pStream);
@@ -2190,6 +2215,7 @@ class CDeviceClass : public CObject
 		bool AccumulateEnhancements (CItemCtx &Device, CInstalledDevice *pTarget, TArray<CString> &EnhancementIDs, CItemEnhancementStack *pEnhancements);
 		void AddTypesUsed (TSortMap<DWORD, bool> *retTypesUsed);
 		ALERROR Bind (SDesignLoadCtx &Ctx);
+		inline bool CanEnhanceDevices (void) const { return (m_Enhancements.GetCount() > 0 || OnCanEnhanceDevices()); }
 		inline CEffectCreator *FindEffectCreator (const CString &sUNID) { return OnFindEffectCreator(sUNID); }
 		inline bool FindEventHandlerDeviceClass (ECachedHandlers iEvent, SEventHandlerDesc *retEvent = NULL) const { if (retEvent) *retEvent = m_CachedEvents[iEvent]; return (m_CachedEvents[iEvent].pCode != NULL); }
 		COverlayType *FireGetOverlayType(CItemCtx &Ctx) const;
@@ -2287,6 +2313,7 @@ class CDeviceClass : public CObject
 
 		virtual bool OnAccumulateEnhancements (CItemCtx &Device, CInstalledDevice *pTarget, TArray<CString> &EnhancementIDs, CItemEnhancementStack *pEnhancements) { return false; }
 		virtual void OnAddTypesUsed (TSortMap<DWORD, bool> *retTypesUsed) { }
+		virtual bool OnCanEnhanceDevices (void) const { return false; }
 		virtual ALERROR OnDesignLoadComplete (SDesignLoadCtx &Ctx) { return NOERROR; }
 		virtual CEffectCreator *OnFindEffectCreator (const CString &sUNID) { return NULL; }
 		virtual void OnMarkImages (void) { }
@@ -3578,7 +3605,6 @@ class CTopologyNode
 		bool FindStargateTo (const CString &sDestNode, CString *retsName = NULL, CString *retsDestGateID = NULL);
 		CString FindStargateName (const CString &sDestNode, const CString &sEntryPoint);
 		inline const CString &GetAttributes (void) const { return m_sAttributes; }
-		inline int GetCalcDistance (void) const { return m_iCalcDistance; }
 		inline const CString &GetData (const CString &sAttrib) const { return m_Data.GetData(sAttrib); }
 		inline CSystemMap *GetDisplayPos (int *retxPos = NULL, int *retyPos = NULL);
 		inline const CString &GetEndGameReason (void) { return m_sEndGameReason; }
@@ -3610,7 +3636,6 @@ class CTopologyNode
 		static ALERROR ParseCriteriaInt (const CString &sCriteria, SCriteria *retCrit);
 		static ALERROR ParsePosition (const CString &sValue, int *retx, int *rety);
 		static ALERROR ParseStargateString (const CString &sStargate, CString *retsNodeID, CString *retsGateName);
-		inline void SetCalcDistance (int iDist) { m_iCalcDistance = iDist; }
 		inline void SetData (const CString &sAttrib, const CString &sData) { m_Data.SetData(sAttrib, sData); }
 		inline void SetEndGameReason (const CString &sReason) { m_sEndGameReason = sReason; }
 		inline void SetEpitaph (const CString &sEpitaph) { m_sEpitaph = sEpitaph; }
@@ -3663,7 +3688,6 @@ class CTopologyNode
 
 		bool m_bKnown;							//	TRUE if node is visible on galactic map
 		bool m_bMarked;							//	Temp variable used during painting
-		int m_iCalcDistance;					//	Temp variable used during distance calc
 	};
 
 class CTopologyNodeList
@@ -4042,8 +4066,10 @@ class CItemType : public CDesignType
 			evtOnInstall				= 3,
 			evtOnEnabled				= 4,
 			evtOnRefuel					= 5,
+			evtOnAIUpdate				= 6,
+			evtOnUpdate					= 7,
 
-			evtCount					= 6,
+			evtCount					= 8,
 			};
 
 		CItemType (void);
@@ -4630,6 +4656,13 @@ class CEffectCreator : public CDesignType
 		inline bool FindEventHandlerEffectType (ECachedHandlers iEvent, SEventHandlerDesc *retEvent = NULL) const { if (retEvent) *retEvent = m_CachedEvents[iEvent]; return (m_CachedEvents[iEvent].pCode != NULL); }
 		static void WritePainterToStream (IWriteStream *pStream, IEffectPainter *pPainter);
 
+		ALERROR CreateEffect (CSystem *pSystem,
+							  CSpaceObject *pAnchor,
+							  const CVector &vPos,
+							  const CVector &vVel,
+							  int iRotation,
+							  int iVariant = 0,
+							  CSpaceObject **retpEffect = NULL);
 		inline CWeaponFireDesc *GetDamageDesc (void) { return m_pDamage; }
 		inline EInstanceTypes GetInstance (void) const { return m_iInstance; }
 		inline const CString &GetUNIDString (void) { return m_sUNID; }
@@ -4638,13 +4671,6 @@ class CEffectCreator : public CDesignType
 
 		//	Virtuals
 
-		virtual ALERROR CreateEffect (CSystem *pSystem,
-									  CSpaceObject *pAnchor,
-									  const CVector &vPos,
-									  const CVector &vVel,
-									  int iRotation,
-									  int iVariant = 0,
-									  CSpaceObject **retpEffect = NULL);
 		virtual IEffectPainter *CreatePainter (CCreatePainterCtx &Ctx) = 0;
 		virtual int GetLifetime (void) { return 0; }
 		virtual CEffectCreator *GetSubEffect (int iIndex) { return NULL; }
@@ -4665,6 +4691,13 @@ class CEffectCreator : public CDesignType
 
 		//	CEffectCreator overrides
 
+		virtual ALERROR OnCreateEffect (CSystem *pSystem,
+										CSpaceObject *pAnchor,
+										const CVector &vPos,
+										const CVector &vVel,
+										int iRotation,
+										int iVariant,
+										CSpaceObject **retpEffect);
 		virtual ALERROR OnEffectCreateFromXML (SDesignLoadCtx &Ctx, CXMLElement *pDesc, const CString &sUNID) { return NOERROR; }
 		virtual ALERROR OnEffectBindDesign (SDesignLoadCtx &Ctx) { return NOERROR; }
 		virtual void OnEffectPlaySound (CSpaceObject *pSource);
@@ -6249,6 +6282,7 @@ class CExtension
 		inline bool IsRegistered (void) const { return m_bRegistered; }
 		inline bool IsRegistrationVerified (void) { return (m_bRegistered && m_bVerified); }
 		ALERROR Load (ELoadStates iDesiredState, IXMLParserController *pResolver, bool bNoResources, bool bKeepXML, CString *retsError);
+		ALERROR PreloadXML (ELoadStates iDesiredState, IXMLParserController *pResolver, CString *retsError);
 		inline void SetDeleted (void) { m_bDeleted = true; }
 		inline void SetDisabled (const CString &sReason) { if (!m_bDisabled) { m_sDisabledReason = sReason; m_bDisabled = true; } }
 		inline void SetDigest (const CIntegerIP &Digest) { m_Digest = Digest; }
@@ -6329,6 +6363,7 @@ class CExtension
 		bool m_bDeleted;
 		bool m_bAutoInclude;				//	Extension should always be included (if appropriate)
 		bool m_bUsesXML;					//	Extension uses XML from other extensions
+		bool m_bXMLPreloaded;				//	m_pRootXML was parsed by PreloadXML
 	};
 
 class CExtensionCollection
@@ -6353,6 +6388,11 @@ class CExtensionCollection
 			FLAG_INCLUDE_AUTO =		0x00000020,	//	Include extensions that are automatic
 			FLAG_AUTO_ONLY =		0x00000040,	//	Only include extensions that are automatic
 			FLAG_ACCUMULATE =		0x00000080,	//	Add to result list
+
+			//	FindBestExtension
+
+			FLAG_NO_LOCK =			0x00000100,	//	Caller holds the lock on another thread
+												//		(used by parallel loading)
 			};
 
 		CExtensionCollection (void);
@@ -6391,6 +6431,7 @@ class CExtensionCollection
 		ALERROR LoadBaseFile (const CString &sFilespec, DWORD dwFlags, CString *retsError);
 		ALERROR LoadFile (const CString &sFilespec, CExtension::EFolderTypes iFolder, DWORD dwFlags, const CIntegerIP &CheckDigest, bool *retbReload, CString *retsError);
 		ALERROR LoadFolderStubsOnly (const CString &sFilespec, CExtension::EFolderTypes iFolder, DWORD dwFlags, CString *retsError);
+		void PreloadExtensions (int iStart, int iCount);
 		bool ReloadDisabledExtensions (DWORD dwFlags);
 
 		CString m_sCollectionFolder;		//	Path to collection folder
@@ -6538,6 +6579,7 @@ class CDesignCollection
 		void FireOnGlobalUpdate (int iTick);
 		inline int GetCount (void) const { return m_AllTypes.GetCount(); }
 		inline int GetCount (DesignTypes iType) const { return m_ByType[iType].GetCount(); }
+		inline DWORD GetBindGeneration (void) const { return m_dwBindGeneration; }
 		inline const CDisplayAttributeDefinitions &GetDisplayAttributes (void) const { return m_DisplayAttribs; }
 		DWORD GetDynamicUNID (const CString &sName);
 		void GetEnabledExtensions (TArray<CExtension *> *retExtensionList);
@@ -6584,6 +6626,7 @@ class CDesignCollection
 		TSortMap<CString, CEconomyType *> m_EconomyIndex;
 		CDisplayAttributeDefinitions m_DisplayAttribs;
 		CGlobalEventCache *m_EventsCache[evtCount];
+		DWORD m_dwBindGeneration;				//	Changes whenever the set of bound types changes
 
 		//	Dynamic design types
 
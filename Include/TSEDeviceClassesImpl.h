@@ -144,6 +144,7 @@ class CEnhancerClass : public CDeviceClass
 
 	protected:
 		virtual bool OnAccumulateEnhancements (CItemCtx &Device, CInstalledDevice *pTarget, TArray<CString> &EnhancementIDs, CItemEnhancementStack *pEnhancements);
+		virtual bool OnCanEnhanceDevices (void) const { return true; }
 
 	private:
 		CEnhancerClass (void);
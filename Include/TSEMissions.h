@@ -52,6 +52,7 @@ class CMission : public CSpaceObject
 							   CString *retsError);
 		void FireCustomEvent (const CString &sEvent, ICCItem *pData);
 		inline DWORD GetAcceptedOn (void) const { return m_dwAcceptedOn; }
+		inline DWORD GetOwnerID (void) const { return m_pOwner.GetID(); }
 		inline bool IsActive (void) const { return (m_iStatus == statusAccepted || (!m_fDebriefed && (m_iStatus == statusPlayerSuccess || m_iStatus == statusPlayerFailure))); }
 		inline bool IsClosed (void) const { return (!IsActive() && IsCompleted()); }
 		inline bool IsCompleted (void) const { return (m_iStatus == statusPlayerSuccess || m_iStatus == statusPlayerFailure || m_iStatus == statusSuccess || m_iStatus == statusFailure); }
@@ -159,13 +160,21 @@ class CMissionList
 		inline int GetCount (void) const { return m_List.GetCount(); }
 		inline CMission *GetMission (int iIndex) const { return m_List[iIndex]; }
 		CMission *GetMissionByID (DWORD dwID) const;
+		inline const TArray<CMission *> *GetMissionsByOwner (DWORD dwOwnerID) const { return m_ByOwner.GetAt(dwOwnerID); }
 		void Insert (CMission *pMission);
+		void OnOwnerChanged (CMission *pMission, DWORD dwOldOwnerID);
 		ALERROR ReadFromStream (SLoadCtx &Ctx, CString *retsError);
 		ALERROR WriteToStream (IWriteStream *pStream, CString *retsError);
 
 	private:
+		void AddToIndex (CMission *pMission);
+		void RemoveFromOwnerIndex (CMission *pMission, DWORD dwOwnerID);
+
 		TArray<CMission *> m_List;
 		bool m_bFree;						//	If TRUE, free missions when removed
+
+		TSortMap<DWORD, CMission *> m_ByID;	//	Missions by ID
+		TSortMap<DWORD, TArray<CMission *>> m_ByOwner;	//	Missions by owner ID (in list order)
 	};
 
 class CTimedMissionEvent : public CTimedEvent
@@ -129,13 +129,13 @@ class CEffectGroupCreator : public CEffectCreator
 		//	Virtuals
 
 		virtual ~CEffectGroupCreator (void);
-		virtual ALERROR CreateEffect (CSystem *pSystem,
-									  CSpaceObject *pAnchor,
-									  const CVector &vPos,
-									  const CVector &vVel,
-									  int iRotation,
-									  int iVariant = 0,
-									  CSpaceObject **retpEffect = NULL);
+		virtual ALERROR OnCreateEffect (CSystem *pSystem,
+										CSpaceObject *pAnchor,
+										const CVector &vPos,
+										const CVector &vVel,
+										int iRotation,
+										int iVariant,
+										CSpaceObject **retpEffect);
 		virtual IEffectPainter *CreatePainter (CCreatePainterCtx &Ctx);
 		virtual int GetLifetime (void);
 		virtual CEffectCreator *GetSubEffect (int iIndex) { if (iIndex < 0 || iIndex >= m_iCount) return NULL; return m_pCreators[iIndex]; }
@@ -180,13 +180,13 @@ class CEffectSequencerCreator : public CEffectCreator
 		inline bool IsTime (int iIndex, int iStart, int iEnd) { return (iStart <= m_Timeline[iIndex].iTime) && (m_Timeline[iIndex].iTime <= iEnd); }
 
 		//	CEffectCreator virtuals
-		virtual ALERROR CreateEffect (CSystem *pSystem,
-									  CSpaceObject *pAnchor,
-									  const CVector &vPos,
-									  const CVector &vVel,
-									  int iRotation,
-									  int iVariant = 0,
-									  CSpaceObject **retpEffect = NULL);
+		virtual ALERROR OnCreateEffect (CSystem *pSystem,
+										CSpaceObject *pAnchor,
+										const CVector &vPos,
+										const CVector &vVel,
+										int iRotation,
+										int iVariant,
+										CSpaceObject **retpEffect);
 		virtual IEffectPainter *CreatePainter (CCreatePainterCtx &Ctx) { ASSERT(false); return NULL; }
 		virtual int GetLifetime (void);
 		virtual CEffectCreator *GetSubEffect (int iIndex) { if (iIndex < 0 || iIndex >= m_Timeline.GetCount()) return NULL; return m_Timeline[iIndex].pCreator; }
@@ -220,13 +220,13 @@ class CEffectVariantCreator : public CEffectCreator
 		inline int GetVariantCreatorIndex (int iVariantValue) { int iIndex; ChooseVariant(iVariantValue, &iIndex); return iIndex; }
 
 		//	CEffectCreator methods
-		virtual ALERROR CreateEffect (CSystem *pSystem,
-									  CSpaceObject *pAnchor,
-									  const CVector &vPos,
-									  const CVector &vVel,
-									  int iRotation,
-									  int iVariant = 0,
-									  CSpaceObject **retpEffect = NULL);
+		virtual ALERROR OnCreateEffect (CSystem *pSystem,
+										CSpaceObject *pAnchor,
+										const CVector &vPos,
+										const CVector &vVel,
+										int iRotation,
+										int iVariant,
+										CSpaceObject **retpEffect);
 		virtual IEffectPainter *CreatePainter (CCreatePainterCtx &Ctx);
 		virtual int GetLifetime (void);
 		virtual CEffectCreator *GetSubEffect (int iIndex) { if (iIndex < 0 || iIndex >= m_Effects.GetCount()) return NULL; return m_Effects[iIndex].pEffect; }
@@ -412,13 +412,13 @@ class CImageFractureEffectCreator : public CEffectCreator
 		virtual CString GetTag (void) { return GetClassTag(); }
 
 		//	CEffectCreator virtuals
-		virtual ALERROR CreateEffect (CSystem *pSystem,
-									  CSpaceObject *pAnchor,
-									  const CVector &vPos,
-									  const CVector &vVel,
-									  int iRotation,
-									  int iVariant = 0,
-									  CSpaceObject **retpEffect = NULL);
+		virtual ALERROR OnCreateEffect (CSystem *pSystem,
+										CSpaceObject *pAnchor,
+										const CVector &vPos,
+										const CVector &vVel,
+										int iRotation,
+										int iVariant,
+										CSpaceObject **retpEffect);
 		virtual IEffectPainter *CreatePainter (CCreatePainterCtx &Ctx) { ASSERT(false); return NULL; }
 
 	protected:
@@ -677,13 +677,13 @@ class CParticleExplosionEffectCreator : public CEffectCreator
 		virtual CString GetTag (void) { return GetClassTag(); }
 
 		//	CEffectCreator virtuals
-		virtual ALERROR CreateEffect (CSystem *pSystem,
-									  CSpaceObject *pAnchor,
-									  const CVector &vPos,
-									  const CVector &vVel,
-									  int iRotation,
-									  int iVariant = 0,
-									  CSpaceObject **retpEffect = NULL);
+		virtual ALERROR OnCreateEffect (CSystem *pSystem,
+										CSpaceObject *pAnchor,
+										const CVector &vPos,
+										const CVector &vVel,
+										int iRotation,
+										int iVariant,
+										CSpaceObject **retpEffect);
 		virtual IEffectPainter *CreatePainter (CCreatePainterCtx &Ctx) { ASSERT(false); return NULL; }
 
 	protected:
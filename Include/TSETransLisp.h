@@ -75,7 +75,21 @@ class CCodeChainCtx
 		CVector AsVector (ICCItem *pItem);
 		inline void Discard (ICCItem *pItem) { pItem->Discard(&m_CC); }
 
+		static void StartProfile (void);
+		static void StopProfile (void);
+
 	private:
+		enum EProfileBuckets
+			{
+			profileUnder10us =				0,
+			profileUnder100us =				1,
+			profileUnder1ms =				2,
+			profileUnder10ms =				3,
+			profileOver10ms =				4,
+
+			profileBucketCount =			5,
+			};
+
 		struct SInvokeFrame
 			{
 			ECodeChainEvents iEvent;		//	Event raised
@@ -84,7 +98,20 @@ class CCodeChainCtx
 			IListData *pListData;
 			};
 
+		struct SHandlerProfile
+			{
+			SHandlerProfile (void) : pCode(NULL), pExtension(NULL), iCalls(0), iTotalTime(0)
+				{ for (int i = 0; i < profileBucketCount; i++) Histogram[i] = 0; }
+
+			ICCItem *pCode;					//	Handler code
+			CExtension *pExtension;			//	Extension that defined the handler
+			int iCalls;						//	Number of invocations
+			LONGLONG iTotalTime;			//	Total time (performance counter units)
+			int Histogram[profileBucketCount];	//	Invocations by duration
+			};
+
 		void AddFrame (void);
+		ICCItem *RunProfiled (ICCItem *pCode);
 		void RemoveFrame (void);
 
 		CCodeChain &m_CC;					//	CodeChain
@@ -107,6 +134,8 @@ class CCodeChainCtx
 		IItemTransform *m_pOldGlobalDefineHook;
 
 		static TArray<SInvokeFrame> g_Invocations;
+		static bool g_bProfile;
+		static TSortMap<DWORD, SHandlerProfile> g_Profile;
 	};
 
 class CFunctionContextWrapper : public ICCAtom
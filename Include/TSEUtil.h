@@ -404,6 +404,7 @@ class CAttributeDataBlock
 		CString GetDataAttrib (int iIndex) const { return m_pData->GetKey(iIndex); }
 		int GetDataCount (void) const { return (m_pData ? m_pData->GetCount() : 0); }
 		CSpaceObject *GetObjRefData (const CString &sAttrib) const;
+		inline bool HasObjRefData (void) const { return (m_pObjRefData != NULL); }
 		inline bool IsEmpty (void) const { return (m_pData == NULL && m_pObjRefData == NULL); }
 		bool IsEqual (const CAttributeDataBlock &Src);
 		void LoadObjReferences (CSystem *pSystem);
@@ -855,8 +856,13 @@ enum SpaceObjectGridFlags
 
 struct SSpaceObjectGridEnumerator
 	{
+	enum
+		{
+		BUFFER_SIZE =						32,	//	Most queries span fewer cells than this
+		};
+
 	SSpaceObjectGridEnumerator (void) : pGridIndexList(NULL) { }
-	~SSpaceObjectGridEnumerator (void) { if (pGridIndexList) delete pGridIndexList; }
+	~SSpaceObjectGridEnumerator (void);
 
 	CSpaceObject *pObj;						//	Current object
 	int iGridIndex;							//	Current grid cell to search
@@ -867,12 +873,21 @@ struct SSpaceObjectGridEnumerator
 
 	int iGridIndexCount;					//	Number of grid indices to traverse
 	CSpaceObjectList **pGridIndexList;		//	Array of grid indices to traverse
+	int iGridIndexAlloc;					//	Bytes allocated for pGridIndexList (0 = Buffer)
+	CSpaceObjectList *Buffer[BUFFER_SIZE];	//	Used for pGridIndexList when big enough
 
 	bool bCheckBox;							//	If TRUE, only return objects in box
 	CVector vLL;							//	Box to check
 	CVector vUR;
 	};
 
+struct SSpaceObjectGridQuery
+	{
+	CVector vUR;							//	Box to check
+	CVector vLL;
+	CSpaceObjectList *pResult;				//	Objects in box are appended here
+	};
+
 class CSpaceObjectGrid
 	{
 	public:
@@ -894,9 +909,11 @@ class CSpaceObjectGrid
 			}
 		CSpaceObject *EnumGetNextInBoxPoint (SSpaceObjectGridEnumerator &i);
 		void GetObjectsInBox (const CVector &vUR, const CVector &vLL, CSpaceObjectList &Result);
+		void GetObjectsInBoxes (SSpaceObjectGridQuery *pQueries, int iCount);
 
 	private:
 		bool EnumGetNextList (SSpaceObjectGridEnumerator &i);
+		void GetCellRange (const CVector &vUR, const CVector &vLL, RECT *retrcCells);
 		bool GetGridCoord (const CVector &vPos, int *retx, int *rety);
 		CSpaceObjectList &GetList (const CVector &vPos);
 		inline CSpaceObjectList &GetList (int x, int y) { return m_pGrid[y * m_iGridSize + x]; }
@@ -961,6 +978,7 @@ class CTimedEvent
 		virtual CString GetEventHandlerName (void) { return NULL_STR; }
 		virtual CSpaceObject *GetEventHandlerObj (void) { return NULL; }
 		virtual CDesignType *GetEventHandlerType (void) { return NULL; }
+		virtual CSpaceObject *GetObjRef (void) { return GetEventHandlerObj(); }
 		virtual bool OnObjChangedSystems (CSpaceObject *pObj) { return false; }
 		virtual bool OnObjDestroyed (CSpaceObject *pObj) { return false; }
 
@@ -979,22 +997,32 @@ class CTimedEvent
 class CTimedEventList
 	{
 	public:
+		CTimedEventList (void) : m_bObjIndexValid(false) { }
 		~CTimedEventList (void);
 
-		inline void AddEvent (CTimedEvent *pEvent) { m_List.Insert(pEvent); }
+		inline void AddEvent (CTimedEvent *pEvent) { m_List.Insert(pEvent); if (m_bObjIndexValid) AddToObjIndex(pEvent); }
 		bool CancelEvent (CSpaceObject *pObj, bool bInDoEvent);
 		bool CancelEvent (CSpaceObject *pObj, const CString &sEvent, bool bInDoEvent);
 		void DeleteAll (void);
 		inline int GetCount (void) const { return m_List.GetCount(); }
 		inline CTimedEvent *GetEvent (int iIndex) const { return m_List[iIndex]; }
-		inline void MoveEvent (int iIndex, CTimedEventList &Dest) { Dest.AddEvent(m_List[iIndex]); m_List.Delete(iIndex); }
+		inline void MoveEvent (int iIndex, CTimedEventList &Dest) { RemoveFromObjIndex(m_List[iIndex]); Dest.AddEvent(m_List[iIndex]); m_List.Delete(iIndex); }
+		void ObjDestroyed (CSpaceObject *pObj);
 		void ReadFromStream (SLoadCtx &Ctx);
-		inline void RemoveEvent (int iIndex) { delete m_List[iIndex]; m_List.Delete(iIndex); }
+		inline void RemoveEvent (int iIndex) { RemoveFromObjIndex(m_List[iIndex]); delete m_List[iIndex]; m_List.Delete(iIndex); }
 		void Update (DWORD dwTick, CSystem *pSystem);
 		void WriteToStream (CSystem *pSystem, IWriteStream *pStream);
 
 	private:
+		void AddToObjIndex (CTimedEvent *pEvent);
+		TArray<CTimedEvent *> *GetObjIndex (CSpaceObject *pObj);
+		void RemoveEventPtr (CTimedEvent *pEvent);
+		void RemoveFromObjIndex (CTimedEvent *pEvent);
+
 		TArray<CTimedEvent *> m_List;
+
+		TSortMap<DWORD, TArray<CTimedEvent *> > m_ObjIndex;	//	Events by GetObjRef (key is pointer)
+		bool m_bObjIndexValid;					//	If FALSE, m_ObjIndex must be rebuilt
 	};
 
 //	Linked-list template class
@@ -1219,6 +1247,38 @@ class CBitGrid
 		CLargeSet m_Grid;
 	};
 
+//	CImageMask -----------------------------------------------------------------
+//
+//	A 1-bit-per-pixel copy of an image's mask, used for hit tests. A bit is set
+//	for every pixel that is not transparent.
+
+class CImageMask
+	{
+	public:
+		CImageMask (void) : m_cxWidth(0), m_cyHeight(0), m_iStride(0), m_pBits(NULL) { }
+		~CImageMask (void) { CleanUp(); }
+
+		void CleanUp (void);
+		ALERROR Create (CG16bitImage &Source);
+		inline int GetHeight (void) const { return m_cyHeight; }
+		inline int GetWidth (void) const { return m_cxWidth; }
+		bool Intersects (int x, int y, const CImageMask &Mask2, int x2, int y2, int cxWidth, int cyHeight) const;
+		inline bool IsSet (int x, int y) const { return ((m_pBits[y * m_iStride + (x >> 5)] & (1 << (x & 31))) != 0); }
+
+	private:
+		inline DWORD GetBits (const DWORD *pRow, int x) const
+			{
+			int iShift = (x & 31);
+			pRow += (x >> 5);
+			return (iShift == 0 ? pRow[0] : ((pRow[0] >> iShift) | (pRow[1] << (32 - iShift))));
+			}
+
+		int m_cxWidth;
+		int m_cyHeight;
+		int m_iStride;						//	DWORDs per row (includes one pad DWORD)
+		DWORD *m_pBits;
+	};
+
 //	C2DFunction ----------------------------------------------------------------
 
 class I2DFunction
@@ -1376,6 +1436,67 @@ class CDeviceStorage
 		bool m_bModified;
 	};
 
+//	Memory statistics ----------------------------------------------------------
+//
+//	Tagged byte counters for the engine's larger allocations. Counting is
+//	always on (a couple of adds per allocation) so that live totals are exact;
+//	WriteReport dumps the totals to the debug log on demand.
+
+class CMemoryStats
+	{
+	public:
+		enum ETags
+			{
+			tagSpaceObjects =				0,	//	CSpaceObject subclasses
+			tagParticles =					1,	//	CParticleArray particles
+			tagImages =						2,	//	Bitmaps loaded by CObjectImage
+			tagSaveBuffers =				3,	//	Serialized game/system streams
+			tagGridQueries =				4,	//	Oversized CSpaceObjectGrid enumerations
+
+			tagCount =						5,
+			};
+
+		static void Alloc (ETags iTag, int iBytes);
+		static inline void Free (ETags iTag, int iBytes) { ::InterlockedExchangeAdd(&g_Stats[iTag].iLive, -iBytes); }
+		static void Transient (ETags iTag, int iBytes);
+		static void WriteReport (void);
+
+	private:
+		struct SStats
+			{
+			volatile LONG iLive;				//	Bytes currently allocated
+			LONG iPeak;							//	Highest value of iLive
+			LONG iAllocs;						//	Allocations since last report
+			LONGLONG iAllocBytes;				//	Bytes allocated since last report
+			};
+
+		static SStats g_Stats[tagCount];
+		static DWORD g_dwLastReport;
+	};
+
+//	Parallel loader ------------------------------------------------------------
+//
+//	Calls OnLoad for each index in [0, iCount) on a small pool of threads and
+//	returns when all are done. OnLoad must only touch data for its own index.
+
+class CParallelLoader
+	{
+	public:
+		CParallelLoader (int iCount) : m_iCount(iCount), m_iNext(0) { }
+		virtual ~CParallelLoader (void) { }
+
+		void Run (void);
+
+	protected:
+		virtual void OnLoad (int iIndex) = 0;
+
+	private:
+		static DWORD WINAPI Thread (LPVOID pData);
+
+		int m_iCount;
+		volatile LONG m_iNext;
+	};
+
 //	Integral Rotation Class ----------------------------------------------------
 
 //	IListData ------------------------------------------------------------------
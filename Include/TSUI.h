@@ -106,9 +106,15 @@ class IHITask : public IHICommand
 		virtual ~IHITask (void) { }
 
 		inline ALERROR GetResult (CString *retsResult) { if (retsResult) *retsResult = m_sResult; return m_Result; }
+		inline bool HICanRunConcurrently (void) { return OnCanRunConcurrently(); }
 		inline ALERROR HIExecute (ITaskProcessor *pProcessor, CString *retsResult) { m_Result = OnExecute(pProcessor, &m_sResult); *retsResult = m_sResult; return m_Result; }
 
 	protected:
+		//	By default tasks do not run concurrently with other (non-concurrent)
+		//	tasks, since many of them share state (e.g., the cloud service).
+		//	Tasks that only touch their own data should override this.
+
+		virtual bool OnCanRunConcurrently (void) { return false; }
 		virtual ALERROR OnExecute (ITaskProcessor *pProcessor, CString *retsResult) { return NOERROR; }
 
 	private:
@@ -228,14 +234,24 @@ class CKeyboardTracker
 class CBackgroundProcessor : public ITaskProcessor
 	{
 	public:
-		CBackgroundProcessor (void) : m_hBackgroundThread(INVALID_HANDLE_VALUE), m_iPercentDone(-1) { }
+		enum ETaskPriorities
+			{
+			priorityLow =					0,
+			priorityNormal =				1,
+			priorityHigh =					2,
+			};
+
+		CBackgroundProcessor (void) : m_hWorkAvailableEvent(NULL), m_hQuitEvent(NULL), m_dwNextID(1), m_iExclusiveRunning(0), m_iExecuting(0), m_iPercentDone(-1) { }
 		~CBackgroundProcessor (void) { CleanUp(); }
 
-		void AddTask (IHITask *pTask, IHICommand *pListener = NULL, const CString &sCmd = NULL_STR);
+		DWORD AddTask (IHITask *pTask, IHICommand *pListener = NULL, const CString &sCmd = NULL_STR, int iPriority = priorityNormal);
+		bool CancelTask (DWORD dwID);
 		void CleanUp (void);
 		ALERROR GetLastResult (CString *retsResult);
 		int GetProgress (CString *retsActivity = NULL);
-		ALERROR Init (HWND hWnd, DWORD dwID);
+		int GetTaskProgress (DWORD dwID, CString *retsActivity = NULL);
+		inline int GetWorkerCount (void) const { return m_Workers.GetCount(); }
+		ALERROR Init (HWND hWnd, DWORD dwID, int iWorkers = 0);
 		void ListenerDestroyed (IHICommand *pListener);
 		void OnTaskComplete (LPARAM pData);
 		bool RegisterOnAllTasksComplete (IHICommand *pListener, const CString &sCmd = NULL);
@@ -257,6 +273,9 @@ class CBackgroundProcessor : public ITaskProcessor
 		struct STask
 			{
 			ETaskStatus iStatus;
+			DWORD dwID;
+			int iPriority;
+			bool bExclusive;				//	Must not run alongside other exclusive tasks
 
 			IHITask *pTask;
 			IHICommand *pListener;
@@ -276,23 +295,66 @@ class CBackgroundProcessor : public ITaskProcessor
 			CString sCmd;
 			};
 
-		inline bool IsInitialized (void) const { return (m_hBackgroundThread != INVALID_HANDLE_VALUE); }
+		//	Each worker thread is also the task processor handed to the task
+		//	it is running, so that progress and cancellation are per-task.
+
+		class CWorker : public ITaskProcessor
+			{
+			public:
+				CWorker (CBackgroundProcessor &Processor) : m_Processor(Processor), 
+						m_hThread(INVALID_HANDLE_VALUE), 
+						m_hCancelEvent(INVALID_HANDLE_VALUE),
+						m_dwTaskID(0),
+						m_iPercentDone(-1)
+					{ }
+				~CWorker (void) { CleanUp(); }
+
+				void CleanUp (void);
+				inline void Cancel (void) { ::SetEvent(m_hCancelEvent); }
+				inline DWORD GetTaskID (void) const { return m_dwTaskID; }
+				int GetProgress (CString *retsActivity = NULL) const;
+				ALERROR Init (void);
+				inline bool IsExecuting (void) const { return (m_dwTaskID != 0); }
+				void SetTask (DWORD dwID);
+
+				//	ITaskProcessor
+				virtual HANDLE GetStopEvent (void) { return m_hCancelEvent; }
+				virtual bool IsStopSignalled (void) { return (::WaitForSingleObject(m_hCancelEvent, 0) != WAIT_TIMEOUT); }
+				virtual void SetProgress (const CString &sActivity, int iPercentDone = -1);
+				virtual void SetResult (ALERROR error, const CString &sResult) { m_Processor.SetResult(error, sResult); }
+
+			private:
+				static DWORD WINAPI Thread (LPVOID pData);
+
+				CBackgroundProcessor &m_Processor;
+				HANDLE m_hThread;
+				HANDLE m_hCancelEvent;		//	Set when the current task is cancelled (or on quit)
+
+				DWORD m_dwTaskID;			//	Task we're running (0 = idle)
+				int m_iPercentDone;
+				CString m_sCurActivity;
+			};
+
+		bool DequeueTask (CWorker *pWorker, STask *retTask);
+		void FinishTask (const STask &Task);
+		inline bool IsInitialized (void) const { return (m_Workers.GetCount() > 0); }
 		void PostOnAllTasksComplete (void);
 		void PostOnTaskComplete (IHITask *pTask);
-
-		static DWORD WINAPI Thread (LPVOID pData);
+		void UpdateWorkAvailable (void);
 
 		HWND m_hWnd;
 		DWORD m_dwID;
 
 		HANDLE m_hWorkAvailableEvent;
 		HANDLE m_hQuitEvent;
-		HANDLE m_hBackgroundThread;
+		TArray<CWorker *> m_Workers;
 
 		CCriticalSection m_cs;
 		TArray<STask> m_Tasks;
 		TArray<SListener> m_GlobalListeners;
-		bool m_bExecuting;
+		DWORD m_dwNextID;					//	Next task ID
+		int m_iExclusiveRunning;			//	Number of exclusive tasks running (0 or 1)
+		int m_iExecuting;					//	Number of tasks running
 
 		//	Progress
 		int m_iPercentDone;
@@ -630,6 +692,7 @@ class CHumanInterface
 			{
 			//	AddBackgroundTask
 			FLAG_LOW_PRIORITY =				0x00000001,
+			FLAG_HIGH_PRIORITY =			0x00000002,
 			};
 
 		static void Run (IHIController *pController, HINSTANCE hInst, int nCmdShow, LPSTR lpCmdLine);
@@ -33,6 +33,11 @@ class CItemDataAnimatron : public IAnimatron
 		TArray<SDamageAdjCell> m_DamageAdj;
 	};
 
+//	NOTE: These tasks stay exclusive (the default). CListCollectionTask and
+//	CReadProfileTask go through the cloud service, which is not thread-safe.
+//	CListCollectionTask and CListSaveFilesTask both create extension icons,
+//	which lazily load cover images without a lock.
+
 class CListCollectionTask : public IHITask
 	{
 	public:
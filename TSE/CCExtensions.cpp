@@ -25,6 +25,9 @@ ICCItem *fnEnvironmentGet (CEvalContext *pEvalCtx, ICCItem *pArgs, DWORD dwData)
 #define FN_DEBUG_LOG				2
 #define FN_PRINT					3
 #define FN_PRINT_TO					4
+#define FN_DEBUG_PROFILE			5
+#define FN_DEBUG_SAVE_FRAME			6
+#define FN_DEBUG_MEMORY				7
 
 ICCItem *fnDebug (CEvalContext *pEvalCtx, ICCItem *pArgs, DWORD dwData);
 
@@ -557,10 +560,33 @@ static PRIMITIVEPROCDEF g_Extensions[] =
 			"(dbgLog [string]*)",
 			"*",	PPFLAG_SIDEEFFECTS,	},
 
+		{	"dbgMemory",					fnDebug,		FN_DEBUG_MEMORY,
+			"(dbgMemory)\n\n"
+			
+			"Writes live bytes, peak bytes, and allocation rates for each\n"
+			"tracked subsystem to the debug log.",
+
+			NULL,	PPFLAG_SIDEEFFECTS,	},
+
 		{	"dbgOutput",					fnDebug,		FN_DEBUG_OUTPUT,
 			"(dbgOutput [string]*)",
 			"*",	PPFLAG_SIDEEFFECTS,	},
 
+		{	"dbgProfile",					fnDebug,		FN_DEBUG_PROFILE,
+			"(dbgProfile True|Nil)\n\n"
+			
+			"True starts profiling event handlers. Nil stops and writes the\n"
+			"results to the debug log.",
+
+			"v",	PPFLAG_SIDEEFFECTS,	},
+
+		{	"dbgSaveFrame",					fnDebug,		FN_DEBUG_SAVE_FRAME,
+			"(dbgSaveFrame filespec width height) -> True/Nil\n\n"
+			
+			"Paints the current point of view and saves it as a bitmap.",
+
+			"sii",	PPFLAG_SIDEEFFECTS,	},
+
 		{	"print",						fnDebug,		FN_PRINT,
 			"(print [string]*)",
 			"*",	PPFLAG_SIDEEFFECTS,	},
@@ -3082,6 +3108,51 @@ ICCItem *fnDebug (CEvalContext *pEvalCtx, ICCItem *pArgs, DWORD dwData)
 				return pCC->CreateTrue();
 			}
 
+		case FN_DEBUG_PROFILE:
+			{
+			//	Only in debug mode
+
+			if (!g_pUniverse->InDebugMode())
+				return pCC->CreateNil();
+
+			if (pArgs->GetElement(0)->IsNil())
+				CCodeChainCtx::StopProfile();
+			else
+				CCodeChainCtx::StartProfile();
+
+			return pCC->CreateTrue();
+			}
+
+		case FN_DEBUG_MEMORY:
+			{
+			//	Only in debug mode
+
+			if (!g_pUniverse->InDebugMode())
+				return pCC->CreateNil();
+
+			CMemoryStats::WriteReport();
+			return pCC->CreateTrue();
+			}
+
+		case FN_DEBUG_SAVE_FRAME:
+			{
+			//	Only in debug mode
+
+			if (!g_pUniverse->InDebugMode())
+				return pCC->CreateNil();
+
+			int cxWidth = pArgs->GetElement(1)->GetIntegerValue();
+			int cyHeight = pArgs->GetElement(2)->GetIntegerValue();
+			if (cxWidth <= 0 || cyHeight <= 0)
+				return pCC->CreateError(CONSTLIT("Invalid frame size"), pArgs);
+
+			CString sError;
+			if (g_pUniverse->PaintPOVToFile(pArgs->GetElement(0)->GetStringValue(), cxWidth, cyHeight, 0, &sError) != NOERROR)
+				return pCC->CreateError(sError);
+
+			return pCC->CreateTrue();
+			}
+
 		default:
 			ASSERT(false);
 			return pCC->CreateNil();
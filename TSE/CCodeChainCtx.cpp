@@ -8,7 +8,11 @@
 #define STR_G_ITEM								CONSTLIT("gItem")
 #define STR_G_SOURCE							CONSTLIT("gSource")
 
+const int PROFILE_SNIPPET_LEN =					60;
+
 TArray<CCodeChainCtx::SInvokeFrame> CCodeChainCtx::g_Invocations;
+bool CCodeChainCtx::g_bProfile = false;
+TSortMap<DWORD, CCodeChainCtx::SHandlerProfile> CCodeChainCtx::g_Profile;
 
 CCodeChainCtx::CCodeChainCtx (void) :
 		m_CC(g_pUniverse->GetCC()),
@@ -301,7 +305,7 @@ ICCItem *CCodeChainCtx::Run (const SEventHandlerDesc &Event)
 	CExtension *pOldExtension = m_pExtension;
 	m_pExtension = Event.pExtension;
 
-	ICCItem *pResult = Run(Event.pCode);
+	ICCItem *pResult = (g_bProfile ? RunProfiled(Event.pCode) : Run(Event.pCode));
 
 	m_pExtension = pOldExtension;
 	return pResult;
@@ -339,6 +343,49 @@ ICCItem *CCodeChainCtx::RunLambda (ICCItem *pCode)
 	DEBUG_CATCH
 	}
 
+ICCItem *CCodeChainCtx::RunProfiled (ICCItem *pCode)
+
+//	RunProfiled
+//
+//	Runs the given event handler and records the number of invocations and the
+//	time spent. Times are inclusive of any handlers that this one calls.
+
+	{
+	LARGE_INTEGER StartTime;
+	LARGE_INTEGER StopTime;
+
+	::QueryPerformanceCounter(&StartTime);
+	ICCItem *pResult = Run(pCode);
+	::QueryPerformanceCounter(&StopTime);
+
+	//	Record
+
+	SHandlerProfile *pProfile = g_Profile.SetAt((DWORD)pCode);
+	pProfile->pCode = pCode;
+	pProfile->pExtension = m_pExtension;
+	pProfile->iCalls++;
+
+	LONGLONG iTime = StopTime.QuadPart - StartTime.QuadPart;
+	pProfile->iTotalTime += iTime;
+
+	LARGE_INTEGER Freq;
+	::QueryPerformanceFrequency(&Freq);
+	LONGLONG iMicroseconds = iTime * 1000000 / Freq.QuadPart;
+
+	if (iMicroseconds < 10)
+		pProfile->Histogram[profileUnder10us]++;
+	else if (iMicroseconds < 100)
+		pProfile->Histogram[profileUnder100us]++;
+	else if (iMicroseconds < 1000)
+		pProfile->Histogram[profileUnder1ms]++;
+	else if (iMicroseconds < 10000)
+		pProfile->Histogram[profileUnder10ms]++;
+	else
+		pProfile->Histogram[profileOver10ms]++;
+
+	return pResult;
+	}
+
 bool CCodeChainCtx::RunEvalString (const CString &sString, bool bPlain, CString *retsResult)
 
 //	RunString
@@ -476,3 +523,71 @@ void CCodeChainCtx::SetGlobalDefineWrapper (CExtension *pExtension)
 		m_bRestoreGlobalDefineHook = true;
 		}
 	}
+
+void CCodeChainCtx::StartProfile (void)
+
+//	StartProfile
+//
+//	Starts recording invocation counts and times for event handlers.
+
+	{
+	g_Profile.DeleteAll();
+	g_bProfile = true;
+	}
+
+void CCodeChainCtx::StopProfile (void)
+
+//	StopProfile
+//
+//	Stops recording and writes the results to the debug log, most expensive
+//	handlers first.
+
+	{
+	int i, j;
+
+	if (!g_bProfile)
+		return;
+
+	g_bProfile = false;
+
+	CCodeChain &CC = g_pUniverse->GetCC();
+	LARGE_INTEGER Freq;
+	::QueryPerformanceFrequency(&Freq);
+
+	//	Sort by total time
+
+	TSortMap<int, TArray<SHandlerProfile *>> ByTime(DescendingSort);
+	for (i = 0; i < g_Profile.GetCount(); i++)
+		{
+		int iTotalMicroseconds = (int)(g_Profile[i].iTotalTime * 1000000 / Freq.QuadPart);
+		ByTime.SetAt(iTotalMicroseconds)->Insert(&g_Profile[i]);
+		}
+
+	//	Output
+
+	kernelDebugLogMessage("Event handler profile: %d handlers", g_Profile.GetCount());
+	kernelDebugLogMessage("calls\ttotal us\t<10us\t<100us\t<1ms\t<10ms\t>=10ms\textension\tcode");
+
+	for (i = 0; i < ByTime.GetCount(); i++)
+		for (j = 0; j < ByTime[i].GetCount(); j++)
+			{
+			SHandlerProfile *pProfile = ByTime[i][j];
+
+			CString sCode = pProfile->pCode->Print(&CC);
+			if (sCode.GetLength() > PROFILE_SNIPPET_LEN)
+				sCode = strSubString(sCode, 0, PROFILE_SNIPPET_LEN);
+
+			kernelDebugLogMessage("%d\t%d\t%d\t%d\t%d\t%d\t%d\t%s\t%s",
+					pProfile->iCalls,
+					ByTime.GetKey(i),
+					pProfile->Histogram[profileUnder10us],
+					pProfile->Histogram[profileUnder100us],
+					pProfile->Histogram[profileUnder1ms],
+					pProfile->Histogram[profileUnder10ms],
+					pProfile->Histogram[profileOver10ms],
+					(pProfile->pExtension ? pProfile->pExtension->GetName() : CONSTLIT("(none)")),
+					sCode);
+			}
+
+	g_Profile.DeleteAll();
+	}
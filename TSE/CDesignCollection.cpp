@@ -37,7 +37,8 @@ static char *CACHED_EVENTS[CDesignCollection::evtCount] =
 
 CDesignCollection::CDesignCollection (void) :
 		m_Base(true),	//	m_Base owns its types and will free them at the end
-		m_pAdventureDesc(NULL)
+		m_pAdventureDesc(NULL),
+		m_dwBindGeneration(1)
 
 //	CDesignCollection construtor
 
@@ -123,6 +124,7 @@ ALERROR CDesignCollection::AddDynamicType (CExtension *pExtension, DWORD dwUNID,
 	//	We start by adding the type to the AllTypes list
 
 	m_AllTypes.AddOrReplaceEntry(pType);
+	m_dwBindGeneration++;
 
 	//	If this is new game time, then it means that we are inside of BindDesign. In
 	//	that case, we don't do anything more (since BindDesign will take care of
@@ -197,6 +199,7 @@ ALERROR CDesignCollection::BindDesign (const TArray<CExtension *> &BindOrder, bo
 
 	DEBUG_TRY
 
+	m_dwBindGeneration++;
 	CShipClass::UnbindGlobal();
 
 	for (i = 0; i < m_AllTypes.GetCount(); i++)
@@ -91,25 +91,24 @@ ALERROR CEffectCreator::CreateEffect (CSystem *pSystem,
 
 //	CreateEffect
 //
-//	Default creation of effect (using CEffect)
+//	Creates an effect object
 
 	{
-	ALERROR error;
-	CEffect *pEffect;
-
-	if (error = CEffect::Create(this,
-			pSystem,
-			pAnchor,
-			vPos,
-			vVel,
-			iRotation,
-			&pEffect))
-		return error;
-
-	if (retpEffect)
-		*retpEffect = pEffect;
+	//	If the system is catching up (reduced-fidelity UpdateExtended) then
+	//	nobody will see the effect, so we skip it. We still create effects 
+	//	that do damage, and we let groups/sequences decide for each sub-effect.
+
+	if (pSystem 
+			&& pSystem->IsCatchUpInProgress()
+			&& m_pDamage == NULL
+			&& GetSubEffect(0) == NULL)
+		{
+		if (retpEffect)
+			*retpEffect = NULL;
+		return NOERROR;
+		}
 
-	return NOERROR;
+	return OnCreateEffect(pSystem, pAnchor, vPos, vVel, iRotation, iVariant, retpEffect);
 	}
 
 ALERROR CEffectCreator::CreateFromTag (const CString &sTag, CEffectCreator **retpCreator)
@@ -653,6 +652,37 @@ ALERROR CEffectCreator::OnBindDesign (SDesignLoadCtx &Ctx)
 		}
 	}
 
+ALERROR CEffectCreator::OnCreateEffect (CSystem *pSystem,
+									    CSpaceObject *pAnchor,
+									    const CVector &vPos,
+									    const CVector &vVel,
+									    int iRotation,
+									    int iVariant,
+									    CSpaceObject **retpEffect)
+
+//	OnCreateEffect
+//
+//	Default creation of effect (using CEffect)
+
+	{
+	ALERROR error;
+	CEffect *pEffect;
+
+	if (error = CEffect::Create(this,
+			pSystem,
+			pAnchor,
+			vPos,
+			vVel,
+			iRotation,
+			&pEffect))
+		return error;
+
+	if (retpEffect)
+		*retpEffect = pEffect;
+
+	return NOERROR;
+	}
+
 ALERROR CEffectCreator::OnCreateFromXML (SDesignLoadCtx &Ctx, CXMLElement *pDesc)
 
 //	OnCreateFromXML
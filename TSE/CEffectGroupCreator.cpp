@@ -399,15 +399,15 @@ void CEffectGroupCreator::ApplyOffsets (SViewportPaintCtx *ioCtx, int *retx, int
 		*rety = -yOffset;
 	}
 
-ALERROR CEffectGroupCreator::CreateEffect (CSystem *pSystem,
-										   CSpaceObject *pAnchor,
-										   const CVector &vPos,
-										   const CVector &vVel,
-										   int iRotation,
-										   int iVariant,
-										   CSpaceObject **retpEffect)
-
-//	CreateEffect
+ALERROR CEffectGroupCreator::OnCreateEffect (CSystem *pSystem,
+										     CSpaceObject *pAnchor,
+										     const CVector &vPos,
+										     const CVector &vVel,
+										     int iRotation,
+										     int iVariant,
+										     CSpaceObject **retpEffect)
+
+//	OnCreateEffect
 //
 //	Creates an effect object
 
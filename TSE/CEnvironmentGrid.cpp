@@ -24,7 +24,8 @@ static SEdgeDesc EDGE_DATA[EDGE_COUNT] =
 	};
 
 CEnvironmentGrid::CEnvironmentGrid (DWORD dwAPIVersion) : 
-		m_Map((dwAPIVersion >= 14 ? defaultSize : sizeCompatible), (dwAPIVersion >= 14 ? defaultScale : scaleCompatibile))
+		m_Map((dwAPIVersion >= 14 ? defaultSize : sizeCompatible), (dwAPIVersion >= 14 ? defaultScale : scaleCompatibile)),
+		m_bVisibleTilesValid(false)
 
 //	CEnvironmentGrid constructor
 
@@ -45,6 +46,43 @@ DWORD CEnvironmentGrid::AddEdgeFlag (DWORD dwTile, DWORD dwEdgeFlag) const
 	return dwNewFlags | (dwTile & 0xFFFF);
 	}
 
+void CEnvironmentGrid::CalcVisibleTiles (int x1, int y1, int x2, int y2)
+
+//	CalcVisibleTiles
+//
+//	Initializes m_VisibleTiles with all non-empty tiles in the given range.
+//	Paint calls us only when the range changes (which happens when the viewport
+//	crosses a tile boundary) or when tiles change, so most frames just walk the
+//	cached list.
+
+	{
+	int x, y;
+
+	m_VisibleTiles.DeleteAll();
+
+	for (x = x1; x <= x2; x++)
+		for (y = y1; y <= y2; y++)
+			{
+			DWORD dwEdgeMask;
+			CSpaceEnvironmentType *pEnv = GetTileType(x, y, &dwEdgeMask);
+			if (pEnv)
+				{
+				SVisibleTile *pTile = m_VisibleTiles.Insert();
+				pTile->x = x;
+				pTile->y = y;
+				pTile->pEnv = pEnv;
+				pTile->dwEdgeMask = dwEdgeMask;
+				pTile->vCenter = TileToVector(x, y);
+				}
+			}
+
+	m_rcVisibleTiles.left = x1;
+	m_rcVisibleTiles.top = y1;
+	m_rcVisibleTiles.right = x2;
+	m_rcVisibleTiles.bottom = y2;
+	m_bVisibleTilesValid = true;
+	}
+
 void CEnvironmentGrid::ConvertSpaceEnvironmentToPointers (CTileMap &UNIDs)
 
 //	ConvertSpaceEnvironmentToPointers
@@ -53,6 +91,7 @@ void CEnvironmentGrid::ConvertSpaceEnvironmentToPointers (CTileMap &UNIDs)
 
 	{
 	m_Map.Init(UNIDs.GetSize(), UNIDs.GetScale());
+	m_bVisibleTilesValid = false;
 
 	STileMapEnumerator k;
 	while (UNIDs.HasMore(k))
@@ -482,7 +521,7 @@ void CEnvironmentGrid::Paint (CG16bitImage &Dest, SViewportPaintCtx &Ctx, const
 	{
 	DEBUG_TRY
 
-	int x, y, x1, y1, x2, y2;
+	int i, x1, y1, x2, y2;
 
 	VectorToTile(vUR, &x2, &y1);
 	VectorToTile(vLL, &x1, &y2);
@@ -492,20 +531,26 @@ void CEnvironmentGrid::Paint (CG16bitImage &Dest, SViewportPaintCtx &Ctx, const
 	x1--; y1--;
 	x2++; y2++;
 
-	for (x = x1; x <= x2; x++)
-		for (y = y1; y <= y2; y++)
-			{
-			DWORD dwEdgeMask;
-			CSpaceEnvironmentType *pEnv = GetTileType(x, y, &dwEdgeMask);
-			if (pEnv)
-				{
-				int xCenter, yCenter;
-				CVector vCenter = TileToVector(x, y);
-				Ctx.XForm.Transform(vCenter, &xCenter, &yCenter);
+	//	Figure out which tiles to paint (if necessary)
 
-				pEnv->Paint(Dest, xCenter, yCenter, x, y, dwEdgeMask);
-				}
-			}
+	if (!m_bVisibleTilesValid
+			|| x1 != m_rcVisibleTiles.left
+			|| y1 != m_rcVisibleTiles.top
+			|| x2 != m_rcVisibleTiles.right
+			|| y2 != m_rcVisibleTiles.bottom)
+		CalcVisibleTiles(x1, y1, x2, y2);
+
+	//	Paint
+
+	for (i = 0; i < m_VisibleTiles.GetCount(); i++)
+		{
+		const SVisibleTile &Tile = m_VisibleTiles[i];
+
+		int xCenter, yCenter;
+		Ctx.XForm.Transform(Tile.vCenter, &xCenter, &yCenter);
+
+		Tile.pEnv->Paint(Dest, xCenter, yCenter, Tile.x, Tile.y, Tile.dwEdgeMask);
+		}
 
 	DEBUG_CATCH
 	}
@@ -628,6 +673,8 @@ void CEnvironmentGrid::ReadFromStream (SLoadCtx &Ctx)
 		if (error = m_Map.ReadFromStream(Ctx.pStream))
 			throw CException(error);
 
+		m_bVisibleTilesValid = false;
+
 		m_iTileCount = m_Map.GetTotalSize();
 		}
 
@@ -690,6 +737,7 @@ void CEnvironmentGrid::SetTileType (int xTile, int yTile, CSpaceEnvironmentType
 		//	Set the new tile
 
 		m_Map.SetTile(xTile, yTile, MakeTileDWORD(pEnv, dwEdgeMask));
+		m_bVisibleTilesValid = false;
 		}
 	}
 
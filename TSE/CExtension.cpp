@@ -78,7 +78,8 @@ CExtension::CExtension (void) :
 		m_bVerified(false),
 		m_bDisabled(false),
 		m_bDeleted(false),
-		m_bUsesXML(false)
+		m_bUsesXML(false),
+		m_bXMLPreloaded(false)
 
 //	CExtension constructor
 
@@ -170,6 +171,8 @@ void CExtension::CleanUpXML (void)
 		m_pRootXML = NULL;
 		}
 
+	m_bXMLPreloaded = false;
+
 	for (i = 0; i < m_ModuleXML.GetCount(); i++)
 		delete m_ModuleXML[i];
 
@@ -859,31 +862,39 @@ ALERROR CExtension::Load (ELoadStates iDesiredState, IXMLParserController *pReso
 					}
 				}
 
-			//	If we've already loaded a root element, then we need to clean up
+			//	If PreloadXML already parsed the file, then we use that.
 
-			if (m_pRootXML)
-				CleanUpXML();
+			if (m_bXMLPreloaded)
+				m_bXMLPreloaded = false;
 
-			//	Parse the XML file into a structure
+			//	Otherwise, parse the XML file into a structure
 
-			if (error = ExtDb.LoadGameFile(&m_pRootXML, pResolver, retsError))
+			else
 				{
-				//	If we're in debug mode then this is a real error.
+				//	If we've already loaded a root element, then we need to clean up
+
+				if (m_pRootXML)
+					CleanUpXML();
 
-				if (g_pUniverse->InDebugMode()
-						&& !ExtDb.IsTDB())
+				if (error = ExtDb.LoadGameFile(&m_pRootXML, pResolver, retsError))
 					{
-					if (retsError) *retsError = strPatternSubst(CONSTLIT("Error parsing %s: %s"), m_sFilespec, *retsError);
-					return ERR_FAIL;
-					}
+					//	If we're in debug mode then this is a real error.
+
+					if (g_pUniverse->InDebugMode()
+							&& !ExtDb.IsTDB())
+						{
+						if (retsError) *retsError = strPatternSubst(CONSTLIT("Error parsing %s: %s"), m_sFilespec, *retsError);
+						return ERR_FAIL;
+						}
 
-				//	Otherwise, we try to continue as if nothing bad had happened, but we
-				//	disable the extension.
+					//	Otherwise, we try to continue as if nothing bad had happened, but we
+					//	disable the extension.
 
-				else
-					{
-					SetDisabled((retsError ? *retsError : CONSTLIT("Unable to load")));
-					return NOERROR;
+					else
+						{
+						SetDisabled((retsError ? *retsError : CONSTLIT("Unable to load")));
+						return NOERROR;
+						}
 					}
 				}
 
@@ -1450,6 +1461,64 @@ ALERROR CExtension::LoadSystemTypesElement (SDesignLoadCtx &Ctx, CXMLElement *pD
 	return NOERROR;
 	}
 
+ALERROR CExtension::PreloadXML (ELoadStates iDesiredState, IXMLParserController *pResolver, CString *retsError)
+
+//	PreloadXML
+//
+//	Parses the XML file (and computes the digest) ahead of a call to Load, so
+//	that Load only needs to load design elements. We only touch this extension,
+//	so this may be called on different extensions in parallel, provided that
+//	pResolver is safe to call from multiple threads.
+//
+//	If we fail, we leave the extension unchanged; Load will parse again and
+//	report the error.
+
+	{
+	ALERROR error;
+
+	//	Nothing to do unless Load would parse the file
+
+	if (m_iLoadState != loadEntities && m_iLoadState != loadAdventureDesc)
+		return NOERROR;
+	else if (iDesiredState == loadNone || iDesiredState == loadEntities)
+		return NOERROR;
+	else if (iDesiredState == loadAdventureDesc && m_iLoadState == loadAdventureDesc)
+		return NOERROR;
+	else if (m_bXMLPreloaded)
+		return NOERROR;
+
+	//	Open the file
+
+	CResourceDb ExtDb(m_sFilespec, true);
+	if (error = ExtDb.Open(DFOPEN_FLAG_READ_ONLY, retsError))
+		return error;
+
+	//	Compute the digest (see Load)
+
+	if (m_Digest.IsEmpty() && GetFolderType() == folderCollection && IsRegistered())
+		{
+		CIntegerIP Digest;
+		if (error = fileCreateDigest(m_sFilespec, &Digest))
+			return error;
+
+		m_Digest = Digest;
+		}
+
+	//	Parse
+
+	CXMLElement *pRootXML;
+	if (error = ExtDb.LoadGameFile(&pRootXML, pResolver, retsError))
+		return error;
+
+	if (m_pRootXML)
+		CleanUpXML();
+
+	m_pRootXML = pRootXML;
+	m_bXMLPreloaded = true;
+
+	return NOERROR;
+	}
+
 void CExtension::SweepImages (void)
 
 //	SweepImages
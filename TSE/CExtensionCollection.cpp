@@ -18,12 +18,14 @@
 #define EXTENSION_TDB								CONSTLIT("tdb")
 #define EXTENSION_XML								CONSTLIT("xml")
 
+#define FILESPEC_CACHE_FOLDER						CONSTLIT("Cache")
 #define FILESPEC_COLLECTION_FOLDER					CONSTLIT("Collection")
 #define FILESPEC_EXTENSIONS_FOLDER					CONSTLIT("Extensions")
 
 #define ERR_CANT_MOVE								CONSTLIT("%s: Unable to move to %s.")
 
 const int DIGEST_SIZE = 20;
+const int PRELOAD_BATCH_SIZE = 32;
 static BYTE g_BaseFileDigest[] =
 	{
     182, 212, 173,   2, 112,  81, 123,  77,  88, 250,
@@ -35,11 +37,13 @@ class CLibraryResolver : public IXMLParserController
 	public:
 		CLibraryResolver (CExtensionCollection &Extensions) : 
 				m_Extensions(Extensions),
+				m_pParallelLock(NULL),
 				m_bReportError(false)
 			{ }
 
 		inline void AddLibrary (CExtension *pLibrary) { m_Libraries.Insert(pLibrary); }
 		inline void ReportLibraryErrors (void) { m_bReportError = true; }
+		inline void SetParallel (CCriticalSection *pLock) { m_pParallelLock = pLock; }
 
 		//	IXMLParserController virtuals
 		virtual ALERROR OnOpenTag (CXMLElement *pElement, CString *retsError);
@@ -49,9 +53,53 @@ class CLibraryResolver : public IXMLParserController
 		CExtensionCollection &m_Extensions;
 
 		TArray<CExtension *> m_Libraries;
+		CCriticalSection *m_pParallelLock;	//	If non-NULL, we're being used on a loader thread
 		bool m_bReportError;				//	If TRUE, we report errors if we fail to load a library
 	};
 
+class CStubLoader : public CParallelLoader
+	{
+	public:
+		struct SStub
+			{
+			CString sFilespec;
+			CExtension *pExtension;
+			ALERROR error;
+			CString sError;
+			};
+
+		CStubLoader (TArray<SStub> &Stubs, CExtension::EFolderTypes iFolder) : CParallelLoader(Stubs.GetCount()),
+				m_Stubs(Stubs),
+				m_iFolder(iFolder)
+			{ }
+
+	protected:
+		virtual void OnLoad (int iIndex);
+
+	private:
+		TArray<SStub> &m_Stubs;
+		CExtension::EFolderTypes m_iFolder;
+	};
+
+class CXMLPreloader : public CParallelLoader
+	{
+	public:
+		CXMLPreloader (CExtensionCollection &Extensions, CExtension *pBase, const TArray<CExtension *> &List) : CParallelLoader(List.GetCount()),
+				m_Extensions(Extensions),
+				m_pBase(pBase),
+				m_List(List)
+			{ }
+
+	protected:
+		virtual void OnLoad (int iIndex);
+
+	private:
+		CExtensionCollection &m_Extensions;
+		CExtension *m_pBase;
+		const TArray<CExtension *> &m_List;
+		CCriticalSection m_csResolve;
+	};
+
 CExtensionCollection::CExtensionCollection (void) :
 		m_sCollectionFolder(FILESPEC_COLLECTION_FOLDER),
 		m_pBase(NULL),
@@ -813,9 +861,18 @@ bool CExtensionCollection::FindBestExtension (DWORD dwUNID, DWORD dwRelease, DWO
 //	Look for the extension that meets the above criteria.
 
 	{
-	CSmartLock Lock(m_cs);
 	int i;
 
+	//	If FLAG_NO_LOCK is set then the caller is a loader thread and the thread
+	//	that owns it already holds the lock (and is not modifying the 
+	//	collection).
+
+	if (!(dwFlags & FLAG_NO_LOCK))
+		{
+		CSmartLock Lock(m_cs);
+		return FindBestExtension(dwUNID, dwRelease, dwFlags | FLAG_NO_LOCK, retpExtension);
+		}
+
 	bool bDebugMode = ((dwFlags & FLAG_DEBUG_MODE) == FLAG_DEBUG_MODE);
 
 	int iPos;
@@ -1097,11 +1154,17 @@ ALERROR CExtensionCollection::Load (const CString &sFilespec, DWORD dwFlags, CSt
 		}
 
 	//	Now that we know about all the extensions that we have, continue loading.
+	//	We parse the files in parallel, a batch at a time (to limit the amount
+	//	of XML in memory); the design elements are loaded in order, because 
+	//	that touches shared state.
 
 	for (i = 0; i < m_Extensions.GetCount(); i++)
 		{
 		CExtension *pExtension = m_Extensions[i];
 
+		if ((i % PRELOAD_BATCH_SIZE) == 0)
+			PreloadExtensions(i, PRELOAD_BATCH_SIZE);
+
 		//	Generate a resolver so that we can look up entities. We always add
 		//	the base file and the extension itself.
 
@@ -1139,12 +1202,23 @@ ALERROR CExtensionCollection::LoadBaseFile (const CString &sFilespec, DWORD dwFl
 	if (m_pBase)
 		return NOERROR;
 
+	DWORD dwStartTime = ::GetTickCount();
+
 	//	Open up the file
 
 	CResourceDb Resources(sFilespec);
 	if (error = Resources.Open(DFOPEN_FLAG_READ_ONLY, retsError))
 		return error;
 
+	//	We need the digest to verify the file and to validate the cache of
+	//	parsed XML.
+
+	CIntegerIP Digest;
+	Resources.ComputeFileDigest(&Digest);
+
+	CString sCacheFilespec = pathAddComponent(FILESPEC_CACHE_FOLDER, strPatternSubst(CONSTLIT("%s.xmc"), pathStripExtension(pathGetFilename(Resources.GetFilespec()))));
+	Resources.OpenCache(sCacheFilespec, Digest);
+
 	//	Log whether or not we're using the XML or TDB files.
 
 	if (Resources.IsUsingExternalGameFile())
@@ -1187,9 +1261,6 @@ ALERROR CExtensionCollection::LoadBaseFile (const CString &sFilespec, DWORD dwFl
 	//
 	//	NOTE: Only TDB is verified; the XML is always considered unregistered.
 
-	CIntegerIP Digest;
-	Resources.ComputeFileDigest(&Digest);
-
 	CIntegerIP CorrectDigest(DIGEST_SIZE, g_BaseFileDigest);
 
 	if (Digest == CorrectDigest)
@@ -1219,6 +1290,13 @@ ALERROR CExtensionCollection::LoadBaseFile (const CString &sFilespec, DWORD dwFl
 	for (i = 0; i < ExtensionsCreated.GetCount(); i++)
 		AddOrReplace(ExtensionsCreated[i]);
 
+	//	Save the parsed XML, if necessary, so we start faster next time.
+
+	Resources.SaveCache();
+
+	if (m_bLoadedInDebugMode)
+		kernelDebugLogMessage("Loaded base file in %d ms.", ::GetTickCount() - dwStartTime);
+
 	return NOERROR;
 	}
 
@@ -1333,8 +1411,9 @@ ALERROR CExtensionCollection::LoadFolderStubsOnly (const CString &sFilespec, CEx
 	if (error = ComputeFilesToLoad(sFilespec, iFolder, FilesToLoad, retsError))
 		return error;
 
-	//	Now loop over the files and load them (if necessary)
+	//	Now make a list of the files that we need to load (or reload)
 
+	TArray<CStubLoader::SStub> Stubs;
 	for (i = 0; i < FilesToLoad.GetCount(); i++)
 		{
 		const CString &sExtensionFilespec = FilesToLoad.GetKey(i);
@@ -1352,10 +1431,39 @@ ALERROR CExtensionCollection::LoadFolderStubsOnly (const CString &sFilespec, CEx
 				continue;
 			}
 
-		//	Create the extension
+		CStubLoader::SStub *pStub = Stubs.Insert();
+		pStub->sFilespec = sExtensionFilespec;
+		pStub->pExtension = NULL;
+		pStub->error = NOERROR;
+		}
+
+	//	Create the stubs in parallel. Each stub only depends on its own file.
+
+	CStubLoader Loader(Stubs, iFolder);
+	Loader.Run();
+
+	//	Now add them to our list in file order, so that the result is the same
+	//	as if we had loaded them one at a time.
+
+	for (i = 0; i < Stubs.GetCount(); i++)
+		{
+		CExtension *pExtension = Stubs[i].pExtension;
+
+		//	If we failed, then free the rest of the stubs and return the 
+		//	(first) error.
+
+		if (Stubs[i].error)
+			{
+			ALERROR error = Stubs[i].error;
+			if (retsError)
+				*retsError = Stubs[i].sError;
+
+			for (; i < Stubs.GetCount(); i++)
+				if (Stubs[i].pExtension)
+					delete Stubs[i].pExtension;
 
-		if (error = CExtension::CreateExtensionStub(sExtensionFilespec, iFolder, &pExtension, retsError))
 			return error;
+			}
 
 		//	If this extension needs XML, then we remember that so that we keep
 		//	XML around after load.
@@ -1363,9 +1471,7 @@ ALERROR CExtensionCollection::LoadFolderStubsOnly (const CString &sFilespec, CEx
 		if (pExtension->UsesXML())
 			m_bKeepXML = true;
 
-		//	Add the extensions to our list. We lock because we expect this function
-		//	to be called without a lock; we don't want to lock while doing the
-		//	expensive load operation.
+		//	Add the extensions to our list.
 
 		AddOrReplace(pExtension);
 		}
@@ -1423,6 +1529,25 @@ ALERROR CExtensionCollection::LoadNewExtension (const CString &sFilespec, const
 		}
 	}
 
+void CExtensionCollection::PreloadExtensions (int iStart, int iCount)
+
+//	PreloadExtensions
+//
+//	Parses the XML for the given range of extensions in parallel (see Load). We
+//	must be called with the lock held and nothing may modify the collection 
+//	until we return.
+
+	{
+	int i;
+
+	TArray<CExtension *> List;
+	for (i = iStart; i < Min(iStart + iCount, m_Extensions.GetCount()); i++)
+		List.Insert(m_Extensions[i]);
+
+	CXMLPreloader Loader(*this, m_pBase, List);
+	Loader.Run();
+	}
+
 bool CExtensionCollection::ReloadDisabledExtensions (DWORD dwFlags)
 
 //	ReloadDisabledExtensions
@@ -1625,8 +1750,14 @@ ALERROR CLibraryResolver::OnOpenTag (CXMLElement *pElement, CString *retsError)
 		//	continue (we will report an error later when we can't find
 		//	the entity).
 
+		DWORD dwFlags = 0;
+		if (m_Extensions.LoadedInDebugMode())
+			dwFlags |= CExtensionCollection::FLAG_DEBUG_MODE;
+		if (m_pParallelLock)
+			dwFlags |= CExtensionCollection::FLAG_NO_LOCK;
+
 		CExtension *pLibrary;
-		if (!m_Extensions.FindBestExtension(dwUNID, dwRelease, (m_Extensions.LoadedInDebugMode() ? CExtensionCollection::FLAG_DEBUG_MODE : 0), &pLibrary))
+		if (!m_Extensions.FindBestExtension(dwUNID, dwRelease, dwFlags, &pLibrary))
 			{
 			*retsError = strPatternSubst(CONSTLIT("Unable to find library: %08x"), dwUNID);
 			return ERR_FAIL;
@@ -1665,15 +1796,39 @@ CString CLibraryResolver::ResolveExternalEntity (const CString &sName, bool *ret
 	{
 	int i;
 
-	for (i = 0; i < m_Libraries.GetCount(); i++)
+	//	If we're on a loader thread, then other threads may be resolving the
+	//	same entities. We serialize access and return a private copy so that
+	//	the threads never share a string.
+
+	if (m_pParallelLock)
+		{
+		CSmartLock Lock(*m_pParallelLock);
+
+		for (i = 0; i < m_Libraries.GetCount(); i++)
+			{
+			bool bFound;
+			CString sResult = m_Libraries[i]->GetEntities()->ResolveExternalEntity(sName, &bFound);
+			if (bFound)
+				{
+				if (retbFound)
+					*retbFound = true;
+				return CString(sResult.GetASCIIZPointer(), sResult.GetLength());
+				}
+			}
+		}
+
+	else
 		{
-		bool bFound;
-		CString sResult = m_Libraries[i]->GetEntities()->ResolveExternalEntity(sName, &bFound);
-		if (bFound)
+		for (i = 0; i < m_Libraries.GetCount(); i++)
 			{
-			if (retbFound)
-				*retbFound = true;
-			return sResult;
+			bool bFound;
+			CString sResult = m_Libraries[i]->GetEntities()->ResolveExternalEntity(sName, &bFound);
+			if (bFound)
+				{
+				if (retbFound)
+					*retbFound = true;
+				return sResult;
+				}
 			}
 		}
 
@@ -1684,3 +1839,55 @@ CString CLibraryResolver::ResolveExternalEntity (const CString &sName, bool *ret
 
 	return NULL_STR;
 	}
+
+//	CStubLoader ----------------------------------------------------------------
+
+void CStubLoader::OnLoad (int iIndex)
+
+//	OnLoad
+//
+//	Creates the stub for the given file.
+
+	{
+	SStub &Stub = m_Stubs[iIndex];
+
+	try
+		{
+		Stub.error = CExtension::CreateExtensionStub(Stub.sFilespec, m_iFolder, &Stub.pExtension, &Stub.sError);
+		}
+	catch (...)
+		{
+		Stub.error = ERR_FAIL;
+		Stub.sError = strPatternSubst(CONSTLIT("Crash loading extension: %s."), Stub.sFilespec);
+		}
+
+	if (Stub.error)
+		Stub.pExtension = NULL;
+	}
+
+//	CXMLPreloader --------------------------------------------------------------
+
+void CXMLPreloader::OnLoad (int iIndex)
+
+//	OnLoad
+//
+//	Parses the XML for the given extension. We ignore errors because Load will
+//	report them.
+
+	{
+	CExtension *pExtension = m_List[iIndex];
+
+	CLibraryResolver Resolver(m_Extensions);
+	Resolver.SetParallel(&m_csResolve);
+	Resolver.AddLibrary(m_pBase);
+	Resolver.AddLibrary(pExtension);
+
+	try
+		{
+		CString sError;
+		pExtension->PreloadXML(CExtension::loadAdventureDesc, &Resolver, &sError);
+		}
+	catch (...)
+		{
+		}
+	}
@@ -698,6 +698,7 @@ ALERROR CGameFile::SaveSystem (DWORD dwUNID, CSystem *pSystem, DWORD dwFlags)
 		return error;
 
 	CString sStream(Stream.GetPointer(), Stream.GetLength(), true);
+	CMemoryStats::Transient(CMemoryStats::tagSaveBuffers, sStream.GetLength());
 
 	//	See if this system has already been saved
 
@@ -838,6 +839,7 @@ ALERROR CGameFile::SaveUniverse (CUniverse &Univ, DWORD dwFlags)
 		return error;
 
 	CString sStream(Stream.GetPointer(), Stream.GetLength(), true);
+	CMemoryStats::Transient(CMemoryStats::tagSaveBuffers, sStream.GetLength());
 
 	//	Keep track to see if we need to update the header
 
@@ -0,0 +1,487 @@
+//	CGameFileCache.cpp
+//
+//	CGameFileCache class
+//	Copyright (c) 2015 by Kronosaur Productions, LLC. All Rights Reserved.
+//
+//	Caches the parsed XML of a TDB file (the game file and its modules) in a
+//	binary form that is much faster to load than XML. The cache is only valid
+//	for a specific source file (we store its digest); if the digest changes we
+//	throw away the cache and rebuild it.
+//
+//	FORMAT
+//
+//	DWORD		'TXMC'
+//	DWORD		version
+//	DWORD		digest length (in bytes)
+//	BYTE[]		digest (padded to DWORD)
+//	DWORD		number of entries
+//
+//	For each entry
+//	CString		entry name
+//	DWORD		length of entry data
+//
+//	Followed by the data for each entry (in order). Each entry is an element:
+//
+//	CString		tag
+//	DWORD		number of attributes
+//	CString		attribute name			(repeats)
+//	CString		attribute value
+//	DWORD		number of sub-elements
+//	CString		content text 0
+//	Element		sub-element i			(repeats)
+//	CString		content text i + 1
+//
+//	CString is a DWORD length followed by the characters (no padding).
+
+#include "PreComp.h"
+
+#define CACHE_SIGNATURE							'TXMC'
+#define CACHE_VERSION							1
+
+void CGameFileCache::Add (const CString &sEntry, CXMLElement *pXML)
+
+//	Add
+//
+//	Adds (or replaces) an entry in the cache. We serialize it immediately, so
+//	the caller retains ownership of pXML.
+
+	{
+	CMemoryWriteStream Stream;
+	if (Stream.Create() != NOERROR)
+		return;
+
+	WriteElement(Stream, pXML);
+
+	SEntry *pEntry = m_Entries.SetAt(sEntry);
+	pEntry->iOffset = 0;
+	pEntry->iLength = 0;
+	pEntry->sData = CString(Stream.GetPointer(), Stream.GetLength());
+
+	m_bModified = true;
+	}
+
+void CGameFileCache::CleanUp (void)
+
+//	CleanUp
+//
+//	Closes the cache file and frees all entries.
+
+	{
+	if (m_pFile)
+		{
+		m_pFile->Close();
+		delete m_pFile;
+		m_pFile = NULL;
+		}
+
+	m_Entries.DeleteAll();
+	m_bModified = false;
+	}
+
+bool CGameFileCache::Find (const CString &sEntry, CXMLElement **retpXML)
+
+//	Find
+//
+//	Looks up the entry and, if found, returns a newly created XML tree (which
+//	the caller must free). Returns FALSE if the entry is not in the cache (or
+//	if the entry is corrupt).
+
+	{
+	SEntry *pEntry = m_Entries.GetAt(sEntry);
+	if (pEntry == NULL)
+		return false;
+
+	char *pPos;
+	char *pEnd;
+	if (pEntry->iLength > 0 && m_pFile)
+		{
+		pPos = m_pFile->GetPointer(pEntry->iOffset, pEntry->iLength);
+		pEnd = pPos + pEntry->iLength;
+		}
+	else if (!pEntry->sData.IsBlank())
+		{
+		pPos = pEntry->sData.GetASCIIZPointer();
+		pEnd = pPos + pEntry->sData.GetLength();
+		}
+	else
+		return false;
+
+	if (pPos == NULL || !ReadElement(&pPos, pEnd, NULL, retpXML))
+		{
+		//	If we can't read the entry, remove it so that we replace it with
+		//	the freshly parsed version.
+
+		m_Entries.DeleteAt(sEntry);
+		return false;
+		}
+
+	return true;
+	}
+
+ALERROR CGameFileCache::Open (const CString &sFilespec, const CIntegerIP &Digest)
+
+//	Open
+//
+//	Opens the given cache file and makes sure that it matches the digest. If
+//	the file does not exist or does not match, we return an error and start
+//	with an empty cache (which will overwrite the file when saved).
+
+	{
+	int i;
+
+	CleanUp();
+	m_sFilespec = sFilespec;
+	m_Digest = Digest;
+
+	if (!pathExists(sFilespec))
+		return ERR_NOTFOUND;
+
+	//	Map the file
+
+	m_pFile = new CFileReadBlock(sFilespec);
+	if (m_pFile->Open() != NOERROR)
+		{
+		CleanUp();
+		return ERR_FAIL;
+		}
+
+	char *pPos = m_pFile->GetPointer(0, -1);
+	if (pPos == NULL)
+		{
+		CleanUp();
+		return ERR_FAIL;
+		}
+
+	char *pStart = pPos;
+	char *pEnd = pPos + m_pFile->GetLength();
+
+	//	Header
+
+	DWORD dwSignature, dwVersion, dwDigestLen;
+	if (!ReadDWORD(&pPos, pEnd, &dwSignature) 
+			|| dwSignature != CACHE_SIGNATURE
+			|| !ReadDWORD(&pPos, pEnd, &dwVersion)
+			|| dwVersion != CACHE_VERSION
+			|| !ReadDWORD(&pPos, pEnd, &dwDigestLen))
+		{
+		CleanUp();
+		return ERR_FAIL;
+		}
+
+	//	Digest must match
+
+	int iPaddedLen = AlignUp((int)dwDigestLen, sizeof(DWORD));
+	if ((int)dwDigestLen != m_Digest.GetLength()
+			|| pEnd - pPos < iPaddedLen)
+		{
+		CleanUp();
+		return ERR_FAIL;
+		}
+
+	BYTE *pDigest = m_Digest.GetBytes();
+	for (i = 0; i < (int)dwDigestLen; i++)
+		if ((BYTE)pPos[i] != pDigest[i])
+			{
+			CleanUp();
+			return ERR_FAIL;
+			}
+
+	pPos += iPaddedLen;
+
+	//	Entry table
+
+	DWORD dwCount;
+	if (!ReadDWORD(&pPos, pEnd, &dwCount))
+		{
+		CleanUp();
+		return ERR_FAIL;
+		}
+
+	TArray<CString> Names;
+	TArray<int> Lengths;
+	for (i = 0; i < (int)dwCount; i++)
+		{
+		CString sName;
+		DWORD dwLength;
+		if (!ReadString(&pPos, pEnd, &sName)
+				|| !ReadDWORD(&pPos, pEnd, &dwLength))
+			{
+			CleanUp();
+			return ERR_FAIL;
+			}
+
+		Names.Insert(sName);
+		Lengths.Insert((int)dwLength);
+		}
+
+	//	Data follows
+
+	int iOffset = (int)(pPos - pStart);
+	for (i = 0; i < Names.GetCount(); i++)
+		{
+		if (iOffset + Lengths[i] > (int)(pEnd - pStart))
+			{
+			CleanUp();
+			return ERR_FAIL;
+			}
+
+		SEntry *pEntry = m_Entries.SetAt(Names[i]);
+		pEntry->iOffset = iOffset;
+		pEntry->iLength = Lengths[i];
+
+		iOffset += Lengths[i];
+		}
+
+	return NOERROR;
+	}
+
+bool CGameFileCache::ReadDWORD (char **iopPos, char *pEnd, DWORD *retdwValue)
+
+//	ReadDWORD
+//
+//	Reads a DWORD
+
+	{
+	if (pEnd - *iopPos < (int)sizeof(DWORD))
+		return false;
+
+	utlMemCopy(*iopPos, (char *)retdwValue, sizeof(DWORD));
+	*iopPos += sizeof(DWORD);
+	return true;
+	}
+
+bool CGameFileCache::ReadElement (char **iopPos, char *pEnd, CXMLElement *pParent, CXMLElement **retpXML)
+
+//	ReadElement
+//
+//	Reads an element (and all its children).
+
+	{
+	DWORD i;
+
+	CString sTag;
+	if (!ReadString(iopPos, pEnd, &sTag))
+		return false;
+
+	CXMLElement *pXML = new CXMLElement(sTag, pParent);
+
+	//	Attributes
+
+	DWORD dwCount;
+	if (!ReadDWORD(iopPos, pEnd, &dwCount))
+		{
+		delete pXML;
+		return false;
+		}
+
+	for (i = 0; i < dwCount; i++)
+		{
+		CString sName;
+		CString sValue;
+		if (!ReadString(iopPos, pEnd, &sName)
+				|| !ReadString(iopPos, pEnd, &sValue))
+			{
+			delete pXML;
+			return false;
+			}
+
+		pXML->AddAttribute(sName, sValue);
+		}
+
+	//	Content
+
+	CString sText;
+	if (!ReadDWORD(iopPos, pEnd, &dwCount)
+			|| !ReadString(iopPos, pEnd, &sText))
+		{
+		delete pXML;
+		return false;
+		}
+
+	if (!sText.IsBlank())
+		pXML->AppendContent(sText);
+
+	for (i = 0; i < dwCount; i++)
+		{
+		CXMLElement *pChild;
+		if (!ReadElement(iopPos, pEnd, pXML, &pChild))
+			{
+			delete pXML;
+			return false;
+			}
+
+		pXML->AppendSubElement(pChild);
+
+		if (!ReadString(iopPos, pEnd, &sText))
+			{
+			delete pXML;
+			return false;
+			}
+
+		if (!sText.IsBlank())
+			pXML->AppendContent(sText);
+		}
+
+	*retpXML = pXML;
+	return true;
+	}
+
+bool CGameFileCache::ReadString (char **iopPos, char *pEnd, CString *retsValue)
+
+//	ReadString
+//
+//	Reads a string
+
+	{
+	DWORD dwLength;
+	if (!ReadDWORD(iopPos, pEnd, &dwLength)
+			|| (DWORD)(pEnd - *iopPos) < dwLength)
+		return false;
+
+	if (dwLength > 0)
+		*retsValue = CString(*iopPos, (int)dwLength);
+	else
+		*retsValue = NULL_STR;
+
+	*iopPos += dwLength;
+	return true;
+	}
+
+ALERROR CGameFileCache::Save (CString *retsError)
+
+//	Save
+//
+//	Writes out the cache file (if anything has changed).
+
+	{
+	int i;
+
+	if (!m_bModified || m_Digest.IsEmpty())
+		return NOERROR;
+
+	//	We're about to overwrite the file that we have mapped, so first copy
+	//	any entries that we loaded from it.
+
+	for (i = 0; i < m_Entries.GetCount(); i++)
+		{
+		SEntry &Entry = m_Entries[i];
+		if (Entry.iLength > 0 && m_pFile)
+			Entry.sData = CString(m_pFile->GetPointer(Entry.iOffset, Entry.iLength), Entry.iLength);
+
+		Entry.iOffset = 0;
+		Entry.iLength = 0;
+		}
+
+	if (m_pFile)
+		{
+		m_pFile->Close();
+		delete m_pFile;
+		m_pFile = NULL;
+		}
+
+	//	Make sure the folder exists
+
+	CString sFolder = pathGetPath(m_sFilespec);
+	if (!sFolder.IsBlank() && !pathExists(sFolder))
+		pathCreate(sFolder);
+
+	//	Write
+
+	CFileWriteStream File(m_sFilespec);
+	if (File.Create() != NOERROR)
+		{
+		if (retsError) *retsError = strPatternSubst(CONSTLIT("Unable to create cache file: %s."), m_sFilespec);
+		return ERR_FAIL;
+		}
+
+	DWORD dwSave = CACHE_SIGNATURE;
+	File.Write((char *)&dwSave, sizeof(DWORD));
+
+	dwSave = CACHE_VERSION;
+	File.Write((char *)&dwSave, sizeof(DWORD));
+
+	dwSave = m_Digest.GetLength();
+	File.Write((char *)&dwSave, sizeof(DWORD));
+	File.Write((char *)m_Digest.GetBytes(), m_Digest.GetLength());
+
+	int iPadding = AlignUp(m_Digest.GetLength(), sizeof(DWORD)) - m_Digest.GetLength();
+	dwSave = 0;
+	if (iPadding > 0)
+		File.Write((char *)&dwSave, iPadding);
+
+	//	Entry table
+
+	dwSave = m_Entries.GetCount();
+	File.Write((char *)&dwSave, sizeof(DWORD));
+
+	for (i = 0; i < m_Entries.GetCount(); i++)
+		{
+		const CString &sName = m_Entries.GetKey(i);
+		dwSave = sName.GetLength();
+		File.Write((char *)&dwSave, sizeof(DWORD));
+		File.Write(sName.GetASCIIZPointer(), sName.GetLength());
+
+		dwSave = m_Entries[i].sData.GetLength();
+		File.Write((char *)&dwSave, sizeof(DWORD));
+		}
+
+	//	Data
+
+	for (i = 0; i < m_Entries.GetCount(); i++)
+		File.Write(m_Entries[i].sData.GetASCIIZPointer(), m_Entries[i].sData.GetLength());
+
+	File.Close();
+	m_bModified = false;
+
+	return NOERROR;
+	}
+
+void CGameFileCache::WriteElement (CMemoryWriteStream &Stream, CXMLElement *pXML)
+
+//	WriteElement
+//
+//	Writes out the element (and all its children).
+
+	{
+	int i;
+	DWORD dwSave;
+
+	WriteString(Stream, pXML->GetTag());
+
+	//	Attributes
+
+	dwSave = pXML->GetAttributeCount();
+	Stream.Write((char *)&dwSave, sizeof(DWORD));
+
+	for (i = 0; i < pXML->GetAttributeCount(); i++)
+		{
+		CString sName = pXML->GetAttributeName(i);
+		WriteString(Stream, sName);
+		WriteString(Stream, pXML->GetAttribute(sName));
+		}
+
+	//	Content
+
+	dwSave = pXML->GetContentElementCount();
+	Stream.Write((char *)&dwSave, sizeof(DWORD));
+
+	WriteString(Stream, pXML->GetContentText(0));
+	for (i = 0; i < pXML->GetContentElementCount(); i++)
+		{
+		WriteElement(Stream, pXML->GetContentElement(i));
+		WriteString(Stream, pXML->GetContentText(i + 1));
+		}
+	}
+
+void CGameFileCache::WriteString (CMemoryWriteStream &Stream, const CString &sValue)
+
+//	WriteString
+//
+//	Writes a string
+
+	{
+	DWORD dwSave = sValue.GetLength();
+	Stream.Write((char *)&dwSave, sizeof(DWORD));
+	if (dwSave > 0)
+		Stream.Write(sValue.GetASCIIZPointer(), sValue.GetLength());
+	}
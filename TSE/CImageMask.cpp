@@ -0,0 +1,126 @@
+//	CImageMask.cpp
+//
+//	CImageMask class
+//	Copyright (c) 2015 by Kronosaur Productions, LLC. All Rights Reserved.
+//
+//	Bits are stored LSB first: pixel x of a row is bit (x & 31) of DWORD
+//	(x >> 5). Each row has one extra DWORD at the end so that GetBits can
+//	always read the DWORD after the one containing x.
+
+#include "PreComp.h"
+
+void CImageMask::CleanUp (void)
+
+//	CleanUp
+//
+//	Free the mask
+
+	{
+	if (m_pBits)
+		{
+		delete [] m_pBits;
+		m_pBits = NULL;
+		}
+
+	m_cxWidth = 0;
+	m_cyHeight = 0;
+	m_iStride = 0;
+	}
+
+ALERROR CImageMask::Create (CG16bitImage &Source)
+
+//	Create
+//
+//	Creates the mask from the image. A pixel is solid if it has non-zero alpha
+//	or (if the image has no alpha channel) if it is not the back color. This
+//	must match the tests in CObjectImageArray::ImagesIntersect.
+
+	{
+	int x, y;
+
+	CleanUp();
+
+	if (Source.GetWidth() <= 0 || Source.GetHeight() <= 0)
+		return ERR_FAIL;
+
+	m_cxWidth = Source.GetWidth();
+	m_cyHeight = Source.GetHeight();
+	m_iStride = ((m_cxWidth + 31) / 32) + 1;
+
+	int iSize = m_iStride * m_cyHeight;
+	m_pBits = new DWORD [iSize];
+	utlMemSet(m_pBits, iSize * sizeof(DWORD), 0);
+
+	if (Source.HasAlpha())
+		{
+		for (y = 0; y < m_cyHeight; y++)
+			{
+			BYTE *pSrc = Source.GetAlphaRow(y);
+			DWORD *pDest = m_pBits + (y * m_iStride);
+
+			for (x = 0; x < m_cxWidth; x++)
+				if (pSrc[x])
+					pDest[x >> 5] |= ((DWORD)1 << (x & 31));
+			}
+		}
+	else
+		{
+		WORD wBackColor = Source.GetBackColor();
+
+		for (y = 0; y < m_cyHeight; y++)
+			{
+			WORD *pSrc = Source.GetRowStart(y);
+			DWORD *pDest = m_pBits + (y * m_iStride);
+
+			for (x = 0; x < m_cxWidth; x++)
+				if (pSrc[x] != wBackColor)
+					pDest[x >> 5] |= ((DWORD)1 << (x & 31));
+			}
+		}
+
+	return NOERROR;
+	}
+
+bool CImageMask::Intersects (int x, int y, const CImageMask &Mask2, int x2, int y2, int cxWidth, int cyHeight) const
+
+//	Intersects
+//
+//	Returns TRUE if the rectangle at x, y (of the given size) in this mask has
+//	any solid pixel in common with the same-sized rectangle at x2, y2 in Mask2.
+//	Both rectangles must be inside their respective masks.
+
+	{
+	int i, xInt;
+
+	if (cxWidth <= 0 || cyHeight <= 0)
+		return false;
+
+	ASSERT(x >= 0 && y >= 0 && x + cxWidth <= m_cxWidth && y + cyHeight <= m_cyHeight);
+	ASSERT(x2 >= 0 && y2 >= 0 && x2 + cxWidth <= Mask2.m_cxWidth && y2 + cyHeight <= Mask2.m_cyHeight);
+
+	//	Mask for the last (partial) DWORD of each row
+
+	int iLastBits = (cxWidth & 31);
+	DWORD dwLastMask = (iLastBits ? (((DWORD)1 << iLastBits) - 1) : 0xffffffff);
+	int xLast = cxWidth - (iLastBits ? iLastBits : 32);
+
+	const DWORD *pRow = m_pBits + (y * m_iStride);
+	const DWORD *pRow2 = Mask2.m_pBits + (y2 * Mask2.m_iStride);
+
+	for (i = 0; i < cyHeight; i++)
+		{
+		//	Compare 32 pixels at a time
+
+		for (xInt = 0; xInt < xLast; xInt += 32)
+			if (GetBits(pRow, x + xInt) & GetBits(pRow2, x2 + xInt))
+				return true;
+
+		if (GetBits(pRow, x + xLast) & GetBits(pRow2, x2 + xLast) & dwLastMask)
+			return true;
+
+		pRow += m_iStride;
+		pRow2 += Mask2.m_iStride;
+		}
+
+	return false;
+	}
@@ -30,6 +30,8 @@
 CItemEnhancement CItem::m_NullMod;
 CItem CItem::m_NullItem;
 
+static bool MatchesItemTypeUncached (const CItemCriteria &Criteria, CItemType *pType);
+
 CItem::CItem (void) : 
 		m_pItemType(NULL), 
 		m_dwCount(0),
@@ -1095,86 +1097,11 @@ bool CItem::MatchesCriteria (const CItemCriteria &Criteria) const
 		return bMatches;
 		}
 
-	//	If we're looking for anything, then continue
-
-	if (Criteria.dwItemCategories == 0xFFFFFFFF)
-		NULL;
-
-	//	If we're looking for fuel and this item is fuel, then
-	//	we continue
-
-	else if ((Criteria.dwItemCategories & itemcatFuel)
-			&& m_pItemType->IsFuel())
-		NULL;
-
-	//	If we're looking for missiles and this item is a
-	//	missile, then we continue.
-
-	else if ((Criteria.dwItemCategories & itemcatMissile)
-			&& m_pItemType->IsMissile())
-		NULL;
-
-	//	If we're looking for usable items and this item is
-	//	isable, then we continue
-
-	else if ((Criteria.dwItemCategories & itemcatUseful)
-			&& m_pItemType->IsUsable())
-		NULL;
-
-	//	Otherwise, if this is not one of the required categories, bail out
+	//	Check the parts of the criteria that only depend on the item type
 
-	else if (!(Criteria.dwItemCategories & m_pItemType->GetCategory()))
+	if (!Criteria.MatchesItemType(m_pItemType))
 		return false;
 
-	//	Deal with exclusion
-
-	if (Criteria.dwExcludeCategories == 0)
-		NULL;
-	else if ((Criteria.dwExcludeCategories & itemcatFuel) && m_pItemType->IsFuel())
-		return false;
-	else if ((Criteria.dwExcludeCategories & itemcatMissile) && m_pItemType->IsMissile())
-		return false;
-	else if ((Criteria.dwExcludeCategories & itemcatUseful) && m_pItemType->IsUsable())
-		return false;
-	else if (Criteria.dwExcludeCategories & m_pItemType->GetCategory())
-		return false;
-
-	//	Deal with must have
-
-	if (Criteria.dwMustHaveCategories != 0)
-		{
-		if ((Criteria.dwMustHaveCategories & itemcatFuel) && !m_pItemType->IsFuel())
-			return false;
-		if ((Criteria.dwMustHaveCategories & itemcatMissile) && !m_pItemType->IsMissile())
-			return false;
-		if ((Criteria.dwMustHaveCategories & itemcatUseful) && !m_pItemType->IsUsable())
-			return false;
-
-		if ((Criteria.dwMustHaveCategories & itemcatDeviceMask) == itemcatDeviceMask)
-			{
-			if (!(m_pItemType->GetCategory() & itemcatDeviceMask))
-				return false;
-			}
-		else if ((Criteria.dwMustHaveCategories & itemcatWeaponMask) == itemcatWeaponMask)
-			{
-			if (!(m_pItemType->GetCategory() & itemcatWeaponMask))
-				return false;
-			}
-		else
-			{
-			DWORD dwCat = 1;
-			for (i = 0; i < itemcatCount; i++)
-				{
-				if (dwCat != itemcatFuel && dwCat != itemcatMissile && dwCat != itemcatUseful
-						&& (Criteria.dwMustHaveCategories & dwCat)
-						&& m_pItemType->GetCategory() != dwCat)
-					return false;
-				
-				dwCat = dwCat << 1;
-				}
-			}
-		}
-
 	//	If any of the flags that must be set is not set, then
 	//	we do not match.
 
@@ -1195,29 +1122,6 @@ bool CItem::MatchesCriteria (const CItemCriteria &Criteria) const
 	if (Criteria.bNotInstalledOnly && IsInstalled())
 		return false;
 
-	//	Check miscellaneous flags
-
-	if (Criteria.bUsableItemsOnly && m_pItemType->GetUseScreen() == NULL)
-		return false;
-
-	if (Criteria.bExcludeVirtual && m_pItemType->IsVirtual())
-		return false;
-
-	if (Criteria.bLauncherMissileOnly && m_pItemType->IsAmmunition())
-		return false;
-
-	//	Check required modifiers
-
-	for (i = 0; i < Criteria.ModifiersRequired.GetCount(); i++)
-		if (!m_pItemType->HasLiteralAttribute(Criteria.ModifiersRequired[i]))
-			return false;
-
-	//	Check modifiers not allowed
-
-	for (i = 0; i < Criteria.ModifiersNotAllowed.GetCount(); i++)
-		if (m_pItemType->HasLiteralAttribute(Criteria.ModifiersNotAllowed[i]))
-			return false;
-
 	//	Check required special attributes
 
 	for (i = 0; i < Criteria.SpecialAttribRequired.GetCount(); i++)
@@ -1230,67 +1134,6 @@ bool CItem::MatchesCriteria (const CItemCriteria &Criteria) const
 		if (HasSpecialAttribute(Criteria.SpecialAttribNotAllowed[i]))
 			return false;
 
-	//	Check frequency range
-
-	if (!Criteria.Frequency.IsBlank())
-		{
-		int iFreq = m_pItemType->GetFrequency();
-		char *pPos = Criteria.Frequency.GetASCIIZPointer();
-		bool bMatch = false;
-		while (*pPos != '\0' && !bMatch)
-			{
-			switch (*pPos)
-				{
-				case 'c':
-				case 'C':
-					if (iFreq == ftCommon)
-						bMatch = true;
-					break;
-
-				case 'u':
-				case 'U':
-					if (iFreq == ftUncommon)
-						bMatch = true;
-					break;
-
-				case 'r':
-				case 'R':
-					if (iFreq == ftRare)
-						bMatch = true;
-					break;
-
-				case 'v':
-				case 'V':
-					if (iFreq == ftVeryRare)
-						bMatch = true;
-					break;
-
-				case '-':
-				case 'n':
-				case 'N':
-					if (iFreq == ftNotRandom)
-						bMatch = true;
-					break;
-				}
-
-			pPos++;
-			}
-
-		if (!bMatch)
-			return false;
-		}
-
-	//	Check for level modifiers
-
-	if (Criteria.iEqualToLevel != -1 && m_pItemType->GetLevel() != Criteria.iEqualToLevel)
-		return false;
-
-	if (Criteria.iGreaterThanLevel != -1 && m_pItemType->GetLevel() <= Criteria.iGreaterThanLevel)
-		return false;
-
-	if (Criteria.iLessThanLevel != -1 && m_pItemType->GetLevel() >= Criteria.iLessThanLevel)
-		return false;
-
 	//	Check for price modifiers
 
 	if (Criteria.iEqualToPrice != -1 && GetValue() != Criteria.iEqualToPrice)
@@ -1355,6 +1198,7 @@ void CItem::InitCriteriaAll (CItemCriteria *retCriteria)
 	retCriteria->iLessThanMass = -1;
 
 	retCriteria->pFilter = NULL;
+	retCriteria->ClearCache();
 	}
 
 void WriteCategoryFlags (CMemoryWriteStream &Output, DWORD dwCategories)
@@ -1555,6 +1399,7 @@ void CItem::ParseCriteria (const CString &sCriteria, CItemCriteria *retCriteria)
 	retCriteria->iLessThanMass = -1;
 
 	retCriteria->pFilter = NULL;
+	retCriteria->ClearCache();
 
 	bool bExclude = false;
 	bool bMustHave = false;
@@ -2306,7 +2151,8 @@ void CItem::WriteToStream (IWriteStream *pStream)
 
 //	CItemCriteria ------------------------------------------------------------
 
-CItemCriteria::CItemCriteria (void) : pFilter(NULL)
+CItemCriteria::CItemCriteria (void) : pFilter(NULL),
+		dwTypeMatchesGeneration(0)
 	{ 
 	}
 
@@ -2348,6 +2194,8 @@ CItemCriteria::CItemCriteria (const CItemCriteria &Copy)
 	pFilter = Copy.pFilter;
 	if (pFilter)
 		pFilter->Reference();
+
+	dwTypeMatchesGeneration = 0;
 	}
 
 CItemCriteria &CItemCriteria::operator= (const CItemCriteria &Copy)
@@ -2392,6 +2240,8 @@ CItemCriteria &CItemCriteria::operator= (const CItemCriteria &Copy)
 	if (pFilter)
 		pFilter->Reference();
 
+	ClearCache();
+
 	return *this;
 	}
 
@@ -2433,3 +2283,206 @@ int CItemCriteria::GetMaxLevelMatched (void) const
 
 	return iMaxLevel;
 	}
+
+bool CItemCriteria::MatchesItemType (CItemType *pType) const
+
+//	MatchesItemType
+//
+//	Returns TRUE if the given item type matches the parts of the criteria that
+//	only depend on the type (categories, modifiers, frequency, and level).
+//	Since these checks involve string searches and we run them for every item
+//	type when refreshing inventory, we cache the result. The cache is valid
+//	until the set of bound design types changes.
+
+	{
+	DWORD dwGeneration = g_pUniverse->GetDesignCollection().GetBindGeneration();
+	if (dwGeneration != dwTypeMatchesGeneration)
+		{
+		TypeMatches.DeleteAll();
+		dwTypeMatchesGeneration = dwGeneration;
+		}
+
+	bool *pMatch = TypeMatches.GetAt(pType->GetUNID());
+	if (pMatch)
+		return *pMatch;
+
+	bool bMatch = MatchesItemTypeUncached(*this, pType);
+	TypeMatches.SetAt(pType->GetUNID(), bMatch);
+	return bMatch;
+	}
+
+static bool MatchesItemTypeUncached (const CItemCriteria &Criteria, CItemType *pType)
+
+//	MatchesItemTypeUncached
+//
+//	Implements CItemCriteria::MatchesItemType.
+
+	{
+	int i;
+
+	//	If we're looking for anything, then continue
+
+	if (Criteria.dwItemCategories == 0xFFFFFFFF)
+		NULL;
+
+	//	If we're looking for fuel and this item is fuel, then
+	//	we continue
+
+	else if ((Criteria.dwItemCategories & itemcatFuel)
+			&& pType->IsFuel())
+		NULL;
+
+	//	If we're looking for missiles and this item is a
+	//	missile, then we continue.
+
+	else if ((Criteria.dwItemCategories & itemcatMissile)
+			&& pType->IsMissile())
+		NULL;
+
+	//	If we're looking for usable items and this item is
+	//	isable, then we continue
+
+	else if ((Criteria.dwItemCategories & itemcatUseful)
+			&& pType->IsUsable())
+		NULL;
+
+	//	Otherwise, if this is not one of the required categories, bail out
+
+	else if (!(Criteria.dwItemCategories & pType->GetCategory()))
+		return false;
+
+	//	Deal with exclusion
+
+	if (Criteria.dwExcludeCategories == 0)
+		NULL;
+	else if ((Criteria.dwExcludeCategories & itemcatFuel) && pType->IsFuel())
+		return false;
+	else if ((Criteria.dwExcludeCategories & itemcatMissile) && pType->IsMissile())
+		return false;
+	else if ((Criteria.dwExcludeCategories & itemcatUseful) && pType->IsUsable())
+		return false;
+	else if (Criteria.dwExcludeCategories & pType->GetCategory())
+		return false;
+
+	//	Deal with must have
+
+	if (Criteria.dwMustHaveCategories != 0)
+		{
+		if ((Criteria.dwMustHaveCategories & itemcatFuel) && !pType->IsFuel())
+			return false;
+		if ((Criteria.dwMustHaveCategories & itemcatMissile) && !pType->IsMissile())
+			return false;
+		if ((Criteria.dwMustHaveCategories & itemcatUseful) && !pType->IsUsable())
+			return false;
+
+		if ((Criteria.dwMustHaveCategories & itemcatDeviceMask) == itemcatDeviceMask)
+			{
+			if (!(pType->GetCategory() & itemcatDeviceMask))
+				return false;
+			}
+		else if ((Criteria.dwMustHaveCategories & itemcatWeaponMask) == itemcatWeaponMask)
+			{
+			if (!(pType->GetCategory() & itemcatWeaponMask))
+				return false;
+			}
+		else
+			{
+			DWORD dwCat = 1;
+			for (i = 0; i < itemcatCount; i++)
+				{
+				if (dwCat != itemcatFuel && dwCat != itemcatMissile && dwCat != itemcatUseful
+						&& (Criteria.dwMustHaveCategories & dwCat)
+						&& pType->GetCategory() != dwCat)
+					return false;
+				
+				dwCat = dwCat << 1;
+				}
+			}
+		}
+
+	//	Check miscellaneous flags
+
+	if (Criteria.bUsableItemsOnly && pType->GetUseScreen() == NULL)
+		return false;
+
+	if (Criteria.bExcludeVirtual && pType->IsVirtual())
+		return false;
+
+	if (Criteria.bLauncherMissileOnly && pType->IsAmmunition())
+		return false;
+
+	//	Check required modifiers
+
+	for (i = 0; i < Criteria.ModifiersRequired.GetCount(); i++)
+		if (!pType->HasLiteralAttribute(Criteria.ModifiersRequired[i]))
+			return false;
+
+	//	Check modifiers not allowed
+
+	for (i = 0; i < Criteria.ModifiersNotAllowed.GetCount(); i++)
+		if (pType->HasLiteralAttribute(Criteria.ModifiersNotAllowed[i]))
+			return false;
+
+	//	Check frequency range
+
+	if (!Criteria.Frequency.IsBlank())
+		{
+		int iFreq = pType->GetFrequency();
+		char *pPos = Criteria.Frequency.GetASCIIZPointer();
+		bool bMatch = false;
+		while (*pPos != '\0' && !bMatch)
+			{
+			switch (*pPos)
+				{
+				case 'c':
+				case 'C':
+					if (iFreq == ftCommon)
+						bMatch = true;
+					break;
+
+				case 'u':
+				case 'U':
+					if (iFreq == ftUncommon)
+						bMatch = true;
+					break;
+
+				case 'r':
+				case 'R':
+					if (iFreq == ftRare)
+						bMatch = true;
+					break;
+
+				case 'v':
+				case 'V':
+					if (iFreq == ftVeryRare)
+						bMatch = true;
+					break;
+
+				case '-':
+				case 'n':
+				case 'N':
+					if (iFreq == ftNotRandom)
+						bMatch = true;
+					break;
+				}
+
+			pPos++;
+			}
+
+		if (!bMatch)
+			return false;
+		}
+
+	//	Check for level modifiers
+
+	if (Criteria.iEqualToLevel != -1 && pType->GetLevel() != Criteria.iEqualToLevel)
+		return false;
+
+	if (Criteria.iGreaterThanLevel != -1 && pType->GetLevel() <= Criteria.iGreaterThanLevel)
+		return false;
+
+	if (Criteria.iLessThanLevel != -1 && pType->GetLevel() >= Criteria.iLessThanLevel)
+		return false;
+
+	return true;
+	}
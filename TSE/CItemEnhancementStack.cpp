@@ -160,6 +160,25 @@ void CItemEnhancementStack::InsertHPBonus (int iBonus)
 	m_Stack[m_Stack.GetCount() - 1].SetModBonus(iBonus);
 	}
 
+bool CItemEnhancementStack::IsEqual (const CItemEnhancementStack &Stack) const
+
+//	IsEqual
+//
+//	Returns TRUE if both stacks have the same enhancements in the same order.
+
+	{
+	int i;
+
+	if (m_Stack.GetCount() != Stack.m_Stack.GetCount())
+		return false;
+
+	for (i = 0; i < m_Stack.GetCount(); i++)
+		if (!m_Stack[i].IsEqual(Stack.m_Stack[i]))
+			return false;
+
+	return true;
+	}
+
 void CItemEnhancementStack::ReadFromStream (SLoadCtx &Ctx, CItemEnhancementStack **retpStack)
 
 //	ReadFromStream
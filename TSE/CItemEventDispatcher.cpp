@@ -4,10 +4,9 @@
 
 #include "PreComp.h"
 
-#define ON_AI_UPDATE_EVENT						CONSTLIT("OnAIUpdate")
-#define ON_UPDATE_EVENT							CONSTLIT("OnUpdate")
-
-CItemEventDispatcher::CItemEventDispatcher (void) : m_pFirstEntry(NULL)
+CItemEventDispatcher::CItemEventDispatcher (void) :
+		m_pFirstUpdate(NULL),
+		m_pFirstAIUpdate(NULL)
 
 //	CItemEventDispatcher constructor
 
@@ -22,85 +21,60 @@ CItemEventDispatcher::~CItemEventDispatcher (void)
 	RemoveAll();
 	}
 
-void CItemEventDispatcher::AddEntry (const CString &sEvent, EItemEventDispatchTypes iType, const SEventHandlerDesc &Event, const CItem &Item, DWORD dwEnhancementID)
+CItemEventDispatcher::SEntry *CItemEventDispatcher::AddEntry (SEntry **ioFirst)
 
 //	AddEntry
 //
-//	Adds an entry
+//	Adds a new entry to the beginning of the given list
 
 	{
-	ECodeChainEvents iEvent;
-
-	if (strEquals(sEvent, ON_AI_UPDATE_EVENT))
-		iEvent = eventOnAIUpdate;
-	else if (strEquals(sEvent, ON_UPDATE_EVENT))
-		iEvent = eventOnUpdate;
-	else
-		iEvent = eventNone;
-
-	if (iEvent != eventNone)
-		{
-		SEntry *pEntry = AddEntry();
-		pEntry->iType = iType;
-		pEntry->iEvent = iEvent;
-		pEntry->Event = Event;
-		pEntry->theItem = Item;
-		pEntry->dwEnhancementID = dwEnhancementID;
-		}
+	SEntry *pEntry = new SEntry;
+	pEntry->pNext = *ioFirst;
+	*ioFirst = pEntry;
+	return pEntry;
 	}
 
-CItemEventDispatcher::SEntry *CItemEventDispatcher::AddEntry (void)
+void CItemEventDispatcher::AddEventEntry (SEntry **ioFirst, ECodeChainEvents iEvent, const SEventHandlerDesc &Event, const CItem &Item)
 
-//	AddEntry
+//	AddEventEntry
 //
-//	Adds a new entry to the beginning of the list
+//	Adds an entry to fire the given event
 
 	{
-	SEntry *pEntry = new SEntry;
-	pEntry->pNext = m_pFirstEntry;
-	m_pFirstEntry = pEntry;
-	return pEntry;
+	SEntry *pEntry = AddEntry(ioFirst);
+	pEntry->iType = dispatchFireEvent;
+	pEntry->iEvent = iEvent;
+	pEntry->Event = Event;
+	pEntry->theItem = Item;
+	pEntry->dwEnhancementID = OBJID_NULL;
 	}
 
 void CItemEventDispatcher::Init (CSpaceObject *pSource)
 
 //	Init
 //
-//	Initializes the dispatcher from the item list
+//	Initializes the dispatcher from the item list. Entries are kept in separate
+//	lists by event so that firing an event only visits the items that handle
+//	it. Item types cache their update handlers at bind time, so items without
+//	handlers cost us nothing more than a couple of checks.
 
 	{
-	int i;
-
 	RemoveAll();
 
 	CItemListManipulator ItemList(pSource->GetItemList());
 	while (ItemList.MoveCursorForward())
 		{
 		const CItem &Item = ItemList.GetItemAtCursor();
+		CItemType *pType = Item.GetType();
 
 		//	Add entries for update events: OnAIUpdate and OnUpdate
 
-		const CEventHandler *pEvents;
-		TSortMap<CString, SEventHandlerDesc> FullEvents;
-		Item.GetType()->GetEventHandlers(&pEvents, &FullEvents);
+		SEventHandlerDesc Event;
+		if (pType->FindEventHandlerItemType(CItemType::evtOnUpdate, &Event))
+			AddEventEntry(&m_pFirstUpdate, eventOnUpdate, Event, Item);
 
-		if (pEvents)
-			{
-			SEventHandlerDesc Event;
-			Event.pExtension = Item.GetType()->GetExtension();
-
-			for (i = 0; i < pEvents->GetCount(); i++)
-				{
-				CString sEvent = pEvents->GetEvent(i, &Event.pCode);
-
-				AddEntry(sEvent, dispatchFireEvent, Event, Item, OBJID_NULL);
-				}
-			}
-		else
-			{
-			for (i = 0; i < FullEvents.GetCount(); i++)
-				AddEntry(FullEvents.GetKey(i), dispatchFireEvent, FullEvents[i], Item, OBJID_NULL);
-			}
+		if (pType->FindEventHandlerItemType(CItemType::evtOnAIUpdate, &Event))
+			AddEventEntry(&m_pFirstAIUpdate, eventOnAIUpdate, Event, Item);
 
 		//	If this item has mods, see if we need to call any mods
 		//	Add entries for OnEnhancementUpdate
@@ -113,7 +87,7 @@ void CItemEventDispatcher::Init (CSpaceObject *pSource)
 
 			if (Item.GetMods().GetExpireTime() != -1)
 				{
-				SEntry *pEntry = AddEntry();
+				SEntry *pEntry = AddEntry(&m_pFirstUpdate);
 				pEntry->iType = dispatchCheckEnhancementLifetime;
 				pEntry->iEvent = eventNone;
 				pEntry->Event.pExtension = NULL;
@@ -123,6 +97,8 @@ void CItemEventDispatcher::Init (CSpaceObject *pSource)
 				}
 			}
 		}
+
+	g_pUniverse->AddItemEventRebuild();
 	}
 
 void CItemEventDispatcher::FireEventFull (CSpaceObject *pSource, ECodeChainEvents iEvent)
@@ -137,7 +113,7 @@ void CItemEventDispatcher::FireEventFull (CSpaceObject *pSource, ECodeChainEvent
 
 	//	Fire event for all items that have it
 
-	SEntry *pEntry = m_pFirstEntry;
+	SEntry *pEntry = (iEvent == eventOnAIUpdate ? m_pFirstAIUpdate : m_pFirstUpdate);
 	while (pEntry)
 		{
 		if (pEntry->iEvent == iEvent)
@@ -179,7 +155,7 @@ void CItemEventDispatcher::FireUpdateEventsFull (CSpaceObject *pSource)
 
 	//	Fire event for all items that have it
 
-	SEntry *pEntry = m_pFirstEntry;
+	SEntry *pEntry = m_pFirstUpdate;
 	while (pEntry)
 		{
 		//	Fire OnUpdate event
@@ -228,7 +204,18 @@ void CItemEventDispatcher::RemoveAll (void)
 //	Remove all entries
 
 	{
-	SEntry *pEntry = m_pFirstEntry;
+	RemoveAll(&m_pFirstUpdate);
+	RemoveAll(&m_pFirstAIUpdate);
+	}
+
+void CItemEventDispatcher::RemoveAll (SEntry **ioFirst)
+
+//	RemoveAll
+//
+//	Remove all entries in the given list
+
+	{
+	SEntry *pEntry = *ioFirst;
 	while (pEntry)
 		{
 		SEntry *pDelete = pEntry;
@@ -236,5 +223,5 @@ void CItemEventDispatcher::RemoveAll (void)
 		delete pDelete;
 		}
 
-	m_pFirstEntry = NULL;
+	*ioFirst = NULL;
 	}
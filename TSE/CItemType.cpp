@@ -118,6 +118,8 @@ static char *CACHED_EVENTS[CItemType::evtCount] =
 		"OnInstall",
 		"OnEnable",
 		"OnRefuel",
+		"OnAIUpdate",
+		"OnUpdate",
 	};
 
 static CStationType *g_pFlotsamStationType = NULL;
@@ -0,0 +1,96 @@
+//	CMemoryStats.cpp
+//
+//	CMemoryStats class
+//	Copyright (c) 2015 by Kronosaur Productions, LLC. All Rights Reserved.
+//
+//	Live byte counts are updated with interlocked adds because images can be
+//	loaded on prefetch threads. The peak and rate counters are not; they are
+//	only approximate if two threads allocate at the same instant.
+
+#include "PreComp.h"
+
+static char *TAG_NAMES[CMemoryStats::tagCount] =
+	{
+	"space objects",
+	"particles",
+	"images",
+	"save buffers",
+	"grid queries",
+	};
+
+CMemoryStats::SStats CMemoryStats::g_Stats[tagCount];
+DWORD CMemoryStats::g_dwLastReport = 0;
+
+void CMemoryStats::Alloc (ETags iTag, int iBytes)
+
+//	Alloc
+//
+//	Records an allocation
+
+	{
+	SStats &Stats = g_Stats[iTag];
+
+	LONG iLive = ::InterlockedExchangeAdd(&Stats.iLive, iBytes) + iBytes;
+	if (iLive > Stats.iPeak)
+		Stats.iPeak = iLive;
+
+	Stats.iAllocs++;
+	Stats.iAllocBytes += iBytes;
+	}
+
+void CMemoryStats::Transient (ETags iTag, int iBytes)
+
+//	Transient
+//
+//	Records a buffer that is freed before the caller returns. This counts
+//	towards the peak and the allocation rate but not the live total.
+
+	{
+	SStats &Stats = g_Stats[iTag];
+
+	LONG iLive = Stats.iLive + iBytes;
+	if (iLive > Stats.iPeak)
+		Stats.iPeak = iLive;
+
+	Stats.iAllocs++;
+	Stats.iAllocBytes += iBytes;
+	}
+
+void CMemoryStats::WriteReport (void)
+
+//	WriteReport
+//
+//	Writes the current totals to the debug log. Allocation rates are computed
+//	over the interval since the previous report.
+
+	{
+	int i;
+
+	DWORD dwNow = ::GetTickCount();
+	DWORD dwElapsed = (g_dwLastReport ? dwNow - g_dwLastReport : 0);
+
+	kernelDebugLogMessage("Memory stats: %d.%03d seconds since last report", dwElapsed / 1000, dwElapsed % 1000);
+	kernelDebugLogMessage("live KB\tpeak KB\tallocs/sec\tKB/sec\ttag");
+
+	for (i = 0; i < tagCount; i++)
+		{
+		SStats &Stats = g_Stats[i];
+
+		int iAllocsPerSec = (dwElapsed ? (int)((LONGLONG)Stats.iAllocs * 1000 / dwElapsed) : 0);
+		int iKBPerSec = (dwElapsed ? (int)(Stats.iAllocBytes * 1000 / ((LONGLONG)dwElapsed * 1024)) : 0);
+
+		kernelDebugLogMessage("%d\t%d\t%d\t%d\t%s",
+				Stats.iLive / 1024,
+				Stats.iPeak / 1024,
+				iAllocsPerSec,
+				iKBPerSec,
+				CString(TAG_NAMES[i]));
+
+		//	Reset the rate counters for the next interval
+
+		Stats.iAllocs = 0;
+		Stats.iAllocBytes = 0;
+		}
+
+	g_dwLastReport = dwNow;
+	}
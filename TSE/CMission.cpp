@@ -776,10 +776,15 @@ void CMission::OnObjDestroyedNotify (SDestroyCtx &Ctx)
 
 		//	Clear out owner pointer (unless we left a wreck)
 
+		DWORD dwOldOwnerID = m_pOwner.GetID();
+
 		if (Ctx.pWreck == NULL)
 			m_pOwner.CleanUp();
 		else if (Ctx.pWreck->GetID() != m_pOwner.GetID())
 			m_pOwner = Ctx.pWreck;
+
+		if (m_pOwner.GetID() != dwOldOwnerID)
+			g_pUniverse->OnMissionOwnerChanged(this, dwOldOwnerID);
 		}
 
 	if (Ctx.pObj->GetID() == m_pDebriefer.GetID())
@@ -5,6 +5,21 @@
 
 #include "PreComp.h"
 
+void CMissionList::AddToIndex (CMission *pMission)
+
+//	AddToIndex
+//
+//	Adds a mission that was just appended to m_List to our indices. Since the
+//	mission is last in the list, it goes last in its owner list.
+//
+//	NOTE: List order is not the same as ID order (a mission created inside
+//	another mission's OnCreate gets a higher ID but is inserted first).
+
+	{
+	m_ByID.SetAt(pMission->GetID(), pMission);
+	m_ByOwner.SetAt(pMission->GetOwnerID())->Insert(pMission);
+	}
+
 void CMissionList::Delete (int iIndex)
 
 //	Delete
@@ -12,8 +27,13 @@ void CMissionList::Delete (int iIndex)
 //	Delete the given mission
 
 	{
+	CMission *pMission = m_List[iIndex];
+
+	m_ByID.DeleteAt(pMission->GetID());
+	RemoveFromOwnerIndex(pMission, pMission->GetOwnerID());
+
 	if (m_bFree)
-		delete m_List[iIndex];
+		delete pMission;
 
 	m_List.Delete(iIndex);
 	}
@@ -46,6 +66,8 @@ void CMissionList::DeleteAll (void)
 		}
 
 	m_List.DeleteAll();
+	m_ByID.DeleteAll();
+	m_ByOwner.DeleteAll();
 	}
 
 CMission *CMissionList::GetMissionByID (DWORD dwID) const
@@ -55,13 +77,8 @@ CMission *CMissionList::GetMissionByID (DWORD dwID) const
 //	Returns a mission of the given ID (or NULL if not found)
 
 	{
-	int i;
-
-	for (i = 0; i < m_List.GetCount(); i++)
-		if (m_List[i]->GetID() == dwID)
-			return m_List[i];
-
-	return NULL;
+	CMission **ppMission = m_ByID.GetAt(dwID);
+	return (ppMission ? *ppMission : NULL);
 	}
 
 void CMissionList::Insert (CMission *pMission)
@@ -72,6 +89,32 @@ void CMissionList::Insert (CMission *pMission)
 
 	{
 	m_List.Insert(pMission);
+	AddToIndex(pMission);
+	}
+
+void CMissionList::OnOwnerChanged (CMission *pMission, DWORD dwOldOwnerID)
+
+//	OnOwnerChanged
+//
+//	The mission's owner has changed (e.g., the owner was destroyed and left a
+//	wreck), so we need to move it in the owner index. The mission can be
+//	anywhere in the list, so we rebuild the new owner's entry from m_List
+//	to keep it in list order. This is rare, so a scan is fine.
+
+	{
+	int i;
+
+	if (m_ByID.GetAt(pMission->GetID()) == NULL)
+		return;
+
+	RemoveFromOwnerIndex(pMission, dwOldOwnerID);
+
+	DWORD dwOwnerID = pMission->GetOwnerID();
+	TArray<CMission *> *pOwned = m_ByOwner.SetAt(dwOwnerID);
+	pOwned->DeleteAll();
+	for (i = 0; i < m_List.GetCount(); i++)
+		if (m_List[i]->GetOwnerID() == dwOwnerID)
+			pOwned->Insert(m_List[i]);
 	}
 
 ALERROR CMissionList::ReadFromStream (SLoadCtx &Ctx, CString *retsError)
@@ -108,11 +151,30 @@ ALERROR CMissionList::ReadFromStream (SLoadCtx &Ctx, CString *retsError)
 		//	Add to global missions
 
 		m_List[i] = pObj->AsMission();
+		AddToIndex(m_List[i]);
 		}
 
 	return NOERROR;
 	}
 
+void CMissionList::RemoveFromOwnerIndex (CMission *pMission, DWORD dwOwnerID)
+
+//	RemoveFromOwnerIndex
+//
+//	Removes the mission from the owner index
+
+	{
+	int iIndex;
+
+	TArray<CMission *> *pOwned = m_ByOwner.GetAt(dwOwnerID);
+	if (pOwned == NULL || !pOwned->Find(pMission, &iIndex))
+		return;
+
+	pOwned->Delete(iIndex);
+	if (pOwned->GetCount() == 0)
+		m_ByOwner.DeleteAt(dwOwnerID);
+	}
+
 ALERROR CMissionList::WriteToStream (IWriteStream *pStream, CString *retsError)
 
 //	WriteToStream
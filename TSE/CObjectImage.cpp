@@ -14,8 +14,12 @@
 
 #define FIELD_IMAGE_DESC					CONSTLIT("imageDesc")
 
+int CalcBitmapBytes (CG16bitImage *pBitmap);
+
 CObjectImage::CObjectImage (void) : 
-		m_pBitmap(NULL)
+		m_pBitmap(NULL),
+		m_pMask(NULL),
+		m_bPrefetchPending(false)
 
 //	CObjectImage constructor
 
@@ -24,18 +28,23 @@ CObjectImage::CObjectImage (void) :
 
 CObjectImage::CObjectImage (CG16bitImage *pBitmap, bool bFreeBitmap) :
 		m_pBitmap(pBitmap),
+		m_pMask(NULL),
 		m_bTransColor(false),
 		m_bSprite(false),
 		m_bPreMult(false),
 		m_bLoadOnUse(false),
 		m_bFreeBitmap(bFreeBitmap),
 		m_bMarked(false),
-		m_bLocked(true)
+		m_bLocked(true),
+		m_bPrefetchPending(false)
 
 //	CObjectImage constructor
 
 	{
 	ASSERT(pBitmap);
+
+	if (m_bFreeBitmap)
+		CMemoryStats::Alloc(CMemoryStats::tagImages, CalcBitmapBytes(m_pBitmap));
 	}
 
 CObjectImage::~CObjectImage (void)
@@ -47,7 +56,13 @@ CObjectImage::~CObjectImage (void)
 	//	This is needed by CObjectImageArray.
 
 	if (m_pBitmap && m_bFreeBitmap)
+		{
+		CMemoryStats::Free(CMemoryStats::tagImages, CalcBitmapBytes(m_pBitmap));
 		delete m_pBitmap;
+		}
+
+	if (m_pMask)
+		delete m_pMask;
 	}
 
 CG16bitImage *CObjectImage::CreateCopy (CString *retsError)
@@ -73,6 +88,9 @@ CG16bitImage *CObjectImage::CreateCopy (CString *retsError)
 	//	Otherwise, we load a copy
 
 	CG16bitImage *pResult = GetImage(NULL_STR, retsError);
+	if (pResult)
+		CMemoryStats::Free(CMemoryStats::tagImages, CalcBitmapBytes(pResult));
+
 	m_pBitmap = NULL;	//	Clear out because we don't keep a copy
 
 	return pResult;
@@ -130,6 +148,32 @@ bool CObjectImage::FindDataField (const CString &sField, CString *retsValue)
 	return true;
 	}
 
+const CImageMask *CObjectImage::GetMask (void)
+
+//	GetMask
+//
+//	Returns a 1-bit mask of the image for hit tests, computing it the first
+//	time. We only do this for images that we own, since otherwise the owner
+//	might change the bitmap behind our back. Returns NULL if the image is not
+//	loaded or if we don't keep a mask.
+
+	{
+	if (m_pMask)
+		return m_pMask;
+
+	if (m_pBitmap == NULL || !m_bFreeBitmap)
+		return NULL;
+
+	m_pMask = new CImageMask;
+	if (m_pMask->Create(*m_pBitmap) != NOERROR)
+		{
+		delete m_pMask;
+		m_pMask = NULL;
+		}
+
+	return m_pMask;
+	}
+
 CG16bitImage *CObjectImage::GetImage (const CString &sLoadReason, CString *retsError)
 
 //	GetImage
@@ -168,40 +212,76 @@ CG16bitImage *CObjectImage::GetImage (CResourceDb &ResDb, const CString &sLoadRe
 //	Returns the image, loading it if necessary
 
 	{
-	ALERROR error;
-
 	//	If we have the image, we're done
 
 	if (m_pBitmap)
 		return m_pBitmap;
 
 	//	If necessary we log that we had to load an image (we generally do this
-	//	to debug issues with loading images in the middle of play).
+	//	to debug issues with loading images in the middle of play). Loads in
+	//	the middle of play are also counted as stalls. Prefetch loads don't come
+	//	through here (see Prefetch), but we check anyway in case something
+	//	loads an image while we're waiting for the helper threads.
+
+	if (!g_pUniverse->IsPrefetchingImages() && g_pUniverse->LogImageLoad())
+		{
+		g_pUniverse->AddImageLoadStall();
+
+		if (g_pUniverse->InDebugMode())
+			kernelDebugLogMessage("Loading image %s for %s.", m_sBitmap, sLoadReason);
+		}
+
+	return LoadBitmap(ResDb, m_sBitmap, m_sBitmask, retsError);
+	}
+
+void CObjectImage::InitPrefetch (SPrefetch *retPrefetch)
+
+//	InitPrefetch
+//
+//	Initializes the parameters that Prefetch needs. This must be called on the
+//	main thread.
 
-	if (g_pUniverse->InDebugMode() && g_pUniverse->LogImageLoad())
-		kernelDebugLogMessage("Loading image %s for %s.", m_sBitmap, sLoadReason);
+	{
+	retPrefetch->sResourceDb = CString(m_sResourceDb.GetASCIIZPointer(), m_sResourceDb.GetLength());
+	retPrefetch->sBitmap = CString(m_sBitmap.GetASCIIZPointer(), m_sBitmap.GetLength());
+	retPrefetch->sBitmask = CString(m_sBitmask.GetASCIIZPointer(), m_sBitmask.GetLength());
+	retPrefetch->bExternalDb = !strEquals(m_sResourceDb, g_pUniverse->GetResourceDb());
+	}
+
+CG16bitImage *CObjectImage::LoadBitmap (CResourceDb &ResDb, const CString &sBitmap, const CString &sBitmask, CString *retsError)
+
+//	LoadBitmap
+//
+//	Loads the image from the given resources.
+//
+//	NOTE: This is called on helper threads by Prefetch, so it must not touch
+//	any strings owned by the image (or anyone else) other than the ones
+//	passed in. Errors are only formatted if retsError is not NULL.
+
+	{
+	ALERROR error;
 
 	//	Load the images
 
 	HBITMAP hDIB = NULL;
 	HBITMAP hBitmask = NULL;
-	if (!m_sBitmap.IsBlank())
+	if (!sBitmap.IsBlank())
 		{
-		if (error = ResDb.LoadImage(NULL_STR, m_sBitmap, &hDIB))
+		if (error = ResDb.LoadImage(NULL_STR, sBitmap, &hDIB))
 			{
 			if (retsError)
-				*retsError = strPatternSubst(CONSTLIT("Unable to load image: '%s'"), m_sBitmap);
+				*retsError = strPatternSubst(CONSTLIT("Unable to load image: '%s'"), sBitmap);
 			return NULL;
 			}
 		}
 
 	EBitmapTypes iMaskType = bitmapNone;
-	if (!m_sBitmask.IsBlank())
+	if (!sBitmask.IsBlank())
 		{
-		if (error = ResDb.LoadImage(NULL_STR, m_sBitmask, &hBitmask, &iMaskType))
+		if (error = ResDb.LoadImage(NULL_STR, sBitmask, &hBitmask, &iMaskType))
 			{
 			if (retsError)
-				*retsError = strPatternSubst(CONSTLIT("Unable to load image: '%s'"), m_sBitmask);
+				*retsError = strPatternSubst(CONSTLIT("Unable to load image: '%s'"), sBitmask);
 			return NULL;
 			}
 		}
@@ -239,7 +319,7 @@ CG16bitImage *CObjectImage::GetImage (CResourceDb &ResDb, const CString &sLoadRe
 		delete m_pBitmap;
 		m_pBitmap = NULL;
 		if (retsError)
-			*retsError = strPatternSubst(CONSTLIT("Unable to create bitmap from image: '%s'"), m_sBitmap);
+			*retsError = strPatternSubst(CONSTLIT("Unable to create bitmap from image: '%s'"), sBitmap);
 		return NULL;
 		}
 
@@ -258,6 +338,8 @@ CG16bitImage *CObjectImage::GetImage (CResourceDb &ResDb, const CString &sLoadRe
 	if (m_bSprite)
 		m_pBitmap->ConvertToSprite();
 
+	CMemoryStats::Alloc(CMemoryStats::tagImages, CalcBitmapBytes(m_pBitmap));
+
 	m_bFreeBitmap = true;
 	return m_pBitmap;
 	}
@@ -280,6 +362,26 @@ ALERROR CObjectImage::Lock (SDesignLoadCtx &Ctx)
 	return NOERROR;
 	}
 
+void CObjectImage::Mark (void)
+
+//	Mark
+//
+//	Marks the image as in use and makes sure it is loaded. If the universe is
+//	collecting images to prefetch, we let it load the image later (in
+//	parallel with other images).
+
+	{
+	m_bMarked = true;
+
+	if (m_pBitmap || m_bPrefetchPending)
+		return;
+
+	if (g_pUniverse->DeferImageLoad(this))
+		m_bPrefetchPending = true;
+	else
+		GetImage(NULL_STR);
+	}
+
 ALERROR CObjectImage::OnCreateFromXML (SDesignLoadCtx &Ctx, CXMLElement *pDesc)
 
 //	CreateFromXML
@@ -330,7 +432,9 @@ ALERROR CObjectImage::OnCreateFromXML (SDesignLoadCtx &Ctx, CXMLElement *pDesc)
 
 	m_bMarked = false;
 	m_bLocked = false;
+	m_bPrefetchPending = false;
 	m_pBitmap = NULL;
+	m_pMask = NULL;
 
 	//	If we're loading on use, make sure the image exists. For other
 	//	images we don't bother checking because we will load them
@@ -381,10 +485,45 @@ void CObjectImage::OnUnbindDesign (void)
 	{
 	if (m_pBitmap && m_bLoadOnUse)
 		{
+		CMemoryStats::Free(CMemoryStats::tagImages, CalcBitmapBytes(m_pBitmap));
 		delete m_pBitmap;
 		m_pBitmap = NULL;
 		m_bLocked = false;
+
+		if (m_pMask)
+			{
+			delete m_pMask;
+			m_pMask = NULL;
+			}
+		}
+	}
+
+void CObjectImage::Prefetch (const SPrefetch &Prefetch)
+
+//	Prefetch
+//
+//	Loads an image that was deferred by Mark. This is called on a helper
+//	thread, but never for the same image on two threads at once. We only use
+//	the strings in Prefetch (see InitPrefetch).
+
+	{
+	//	Like Mark, we ignore errors; if the image fails to load, whoever
+	//	paints it will try again.
+
+	if (m_pBitmap == NULL)
+		{
+		try
+			{
+			CResourceDb ResDb(Prefetch.sResourceDb, Prefetch.bExternalDb);
+			if (ResDb.Open(DFOPEN_FLAG_READ_ONLY, NULL) == NOERROR)
+				LoadBitmap(ResDb, Prefetch.sBitmap, Prefetch.sBitmask, NULL);
+			}
+		catch (...)
+			{
+			}
 		}
+
+	m_bPrefetchPending = false;
 	}
 
 void CObjectImage::Sweep (void)
@@ -396,7 +535,28 @@ void CObjectImage::Sweep (void)
 	{
 	if (!m_bLocked && !m_bMarked && m_pBitmap)
 		{
+		CMemoryStats::Free(CMemoryStats::tagImages, CalcBitmapBytes(m_pBitmap));
 		delete m_pBitmap;
 		m_pBitmap = NULL;
+
+		if (m_pMask)
+			{
+			delete m_pMask;
+			m_pMask = NULL;
+			}
 		}
 	}
+
+//	Utility -------------------------------------------------------------------
+
+int CalcBitmapBytes (CG16bitImage *pBitmap)
+
+//	CalcBitmapBytes
+//
+//	Estimates the memory used by a bitmap: 16 bits per pixel plus an 8-bit
+//	alpha channel, if any.
+
+	{
+	int iPixels = pBitmap->GetWidth() * pBitmap->GetHeight();
+	return iPixels * (pBitmap->HasAlpha() ? 3 : 2);
+	}
@@ -629,6 +629,14 @@ bool CObjectImageArray::ImagesIntersect (int iTick, int iRotation, int x, int y,
 	if (pSrc1 == NULL || pSrc2 == NULL)
 		return false;
 
+	//	If we have masks for both images, then we compare 32 pixels at a time.
+	//	The masks encode the same per-pixel tests as the loops below.
+
+	const CImageMask *pMask1 = m_pImage->GetMask();
+	const CImageMask *pMask2 = Image2.m_pImage->GetMask();
+	if (pMask1 && pMask2)
+		return pMask1->Intersects(rcRectInt.left, rcRectInt.top, *pMask2, rcRectInt2.left, rcRectInt2.top, RectWidth(rcRectInt), RectHeight(rcRectInt));
+
 	//	If both rectangles have a mask
 
 	if (pSrc1->HasAlpha() && pSrc2->HasAlpha())
@@ -1,6 +1,13 @@
 //	CObjectTracker.cpp
 //
 //	CObjectTracker class
+//
+//	Whether an object list matches a query depends only on its type, so for
+//	universe-wide queries we test each distinct type once (instead of once per
+//	node). If the query requires literal attributes, we only test the types 
+//	that have the rarest of them. We remember which types have a given 
+//	attribute (computed with CDesignType::HasLiteralAttribute, so the results
+//	are the same as a full scan).
 
 #include "PreComp.h"
 
@@ -20,7 +27,6 @@ bool CObjectTracker::AccumulateEntries (TArray<SObjList *> &Table, const CDesign
 
 	{
 	int i;
-	int j;
 
 	for (i = 0; i < Table.GetCount(); i++)
 		{
@@ -38,22 +44,7 @@ bool CObjectTracker::AccumulateEntries (TArray<SObjList *> &Table, const CDesign
 
 		//	Otherwise, add all objects to the results
 
-		for (j = 0; j < pList->ObjectIDs.GetCount(); j++)
-			{
-			SObjEntry *pEntry = retResult->Insert();
-			pEntry->pNode = pList->pNode;
-			pEntry->pType = pList->pType;
-			pEntry->dwObjID = pList->ObjectIDs[j];
-
-			SObjName *pName = pList->ObjectNames.GetAt(pEntry->dwObjID);
-			if (pName)
-				{
-				pEntry->sName = pName->sName;
-				pEntry->dwNameFlags = pName->dwNameFlags;
-				}
-			else
-				pEntry->sName = pList->pType->GetTypeName(&pEntry->dwNameFlags);
-			}
+		AddEntries(pList, retResult);
 		}
 
 	//	Done
@@ -61,6 +52,33 @@ bool CObjectTracker::AccumulateEntries (TArray<SObjList *> &Table, const CDesign
 	return (retResult && retResult->GetCount() > 0);
 	}
 
+void CObjectTracker::AddEntries (SObjList *pList, TArray<SObjEntry> *retResult)
+
+//	AddEntries
+//
+//	Adds all objects in the list to the result.
+
+	{
+	int i;
+
+	for (i = 0; i < pList->ObjectIDs.GetCount(); i++)
+		{
+		SObjEntry *pEntry = retResult->Insert();
+		pEntry->pNode = pList->pNode;
+		pEntry->pType = pList->pType;
+		pEntry->dwObjID = pList->ObjectIDs[i];
+
+		SObjName *pName = pList->ObjectNames.GetAt(pEntry->dwObjID);
+		if (pName)
+			{
+			pEntry->sName = pName->sName;
+			pEntry->dwNameFlags = pName->dwNameFlags;
+			}
+		else
+			pEntry->sName = pList->pType->GetTypeName(&pEntry->dwNameFlags);
+		}
+	}
+
 void CObjectTracker::Delete (CSpaceObject *pObj)
 
 //	Delete
@@ -97,6 +115,10 @@ void CObjectTracker::DeleteAll (void)
 
 	m_AllLists.DeleteAll();
 	m_ByNode.DeleteAll();
+
+	m_Types.DeleteAll();
+	m_TypeIndex.DeleteAll();
+	m_ByAttrib.DeleteAll();
 	}
 
 bool CObjectTracker::Find (const CString &sNodeID, const CDesignTypeCriteria &Criteria, TArray<SObjEntry> *retResult)
@@ -112,7 +134,7 @@ bool CObjectTracker::Find (const CString &sNodeID, const CDesignTypeCriteria &Cr
 	//	If no node ID, then we look through all nodes
 
 	if (sNodeID.IsBlank())
-		return AccumulateEntries(m_AllLists, Criteria, retResult);
+		return FindAll(Criteria, retResult);
 
 	//	Otherwise, check the specific node
 
@@ -130,6 +152,79 @@ bool CObjectTracker::Find (const CString &sNodeID, const CDesignTypeCriteria &Cr
 		}
 	}
 
+bool CObjectTracker::FindAll (const CDesignTypeCriteria &Criteria, TArray<SObjEntry> *retResult)
+
+//	FindAll
+//
+//	Find objects matching the given criteria across all nodes. Results are in
+//	the same order as AccumulateEntries on m_AllLists.
+
+	{
+	int i;
+
+	//	Figure out which types we need to test. If we require any literal
+	//	attributes, then we only need to look at types with the rarest one.
+	//
+	//	NOTE: GetTypesWithAttribute can add entries to m_ByAttrib (which moves
+	//	the other entries) so we bring all the indices up to date before we
+	//	hold on to a pointer.
+
+	int iRarest = -1;
+	int iRarestCount = 0;
+	for (i = 0; i < Criteria.GetRequiredAttribCount(); i++)
+		{
+		int iTypeCount = GetTypesWithAttribute(Criteria.GetRequiredAttrib(i)).GetCount();
+		if (iRarest == -1 || iTypeCount < iRarestCount)
+			{
+			iRarest = i;
+			iRarestCount = iTypeCount;
+			}
+		}
+
+	const TArray<int> *pCandidates = (iRarest != -1 ? &m_ByAttrib.GetAt(Criteria.GetRequiredAttrib(iRarest))->Types : NULL);
+
+	//	Test each candidate type once
+
+	TArray<bool> Matched;
+	Matched.InsertEmpty(m_Types.GetCount());
+	for (i = 0; i < m_Types.GetCount(); i++)
+		Matched[i] = false;
+
+	bool bFound = false;
+	int iCount = (pCandidates ? pCandidates->GetCount() : m_Types.GetCount());
+	for (i = 0; i < iCount; i++)
+		{
+		int iType = (pCandidates ? pCandidates->GetAt(i) : i);
+		if (m_Types[iType]->MatchesCriteria(Criteria))
+			{
+			//	Every type in m_Types has at least one list, so if all we care
+			//	about is whether we have any entries, then we're done.
+
+			if (retResult == NULL)
+				return true;
+
+			Matched[iType] = true;
+			bFound = true;
+			}
+		}
+
+	if (!bFound)
+		return false;
+
+	//	Add all objects from matching lists
+
+	for (i = 0; i < m_AllLists.GetCount(); i++)
+		{
+		SObjList *pList = m_AllLists[i];
+		if (Matched[pList->iType])
+			AddEntries(pList, retResult);
+		}
+
+	//	Done
+
+	return (retResult->GetCount() > 0);
+	}
+
 CObjectTracker::SObjList *CObjectTracker::GetList (CSpaceObject *pObj)
 
 //	GetList
@@ -181,6 +276,7 @@ CObjectTracker::SObjList *CObjectTracker::GetList (CTopologyNode *pNode, CDesign
 	SObjList *pNewList = new SObjList;
 	pNewList->pNode = pNode;
 	pNewList->pType = pType;
+	pNewList->iType = GetTypeIndex(pType);
 
 	//	Add to the flat list
 
@@ -195,6 +291,45 @@ CObjectTracker::SObjList *CObjectTracker::GetList (CTopologyNode *pNode, CDesign
 	return pNewList;
 	}
 
+int CObjectTracker::GetTypeIndex (CDesignType *pType)
+
+//	GetTypeIndex
+//
+//	Returns the index of the type in m_Types (adding it, if necessary).
+
+	{
+	int *pIndex = m_TypeIndex.GetAt(pType->GetUNID());
+	if (pIndex)
+		return *pIndex;
+
+	int iIndex = m_Types.GetCount();
+	m_Types.Insert(pType);
+	m_TypeIndex.Insert(pType->GetUNID(), iIndex);
+
+	return iIndex;
+	}
+
+const TArray<int> &CObjectTracker::GetTypesWithAttribute (const CString &sAttrib)
+
+//	GetTypesWithAttribute
+//
+//	Returns the indices of all types that have the given literal attribute.
+//	We only need to check types added since the last time we were called.
+
+	{
+	int i;
+
+	SAttribIndex *pIndex = m_ByAttrib.SetAt(sAttrib);
+
+	for (i = pIndex->iTypesChecked; i < m_Types.GetCount(); i++)
+		if (m_Types[i]->HasLiteralAttribute(sAttrib))
+			pIndex->Types.Insert(i);
+
+	pIndex->iTypesChecked = m_Types.GetCount();
+
+	return pIndex->Types;
+	}
+
 void CObjectTracker::Insert (CSpaceObject *pObj)
 
 //	Insert
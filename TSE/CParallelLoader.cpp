@@ -0,0 +1,62 @@
+//	CParallelLoader.cpp
+//
+//	CParallelLoader class
+//	Copyright (c) 2015 by Kronosaur Productions, LLC. All Rights Reserved.
+
+#include "PreComp.h"
+
+const int MAX_LOAD_THREADS =				8;
+
+void CParallelLoader::Run (void)
+
+//	Run
+//
+//	Calls OnLoad for every index, using as many threads as makes sense. We
+//	return when all are done.
+
+	{
+	int i;
+
+	SYSTEM_INFO SysInfo;
+	::GetSystemInfo(&SysInfo);
+	int iThreads = Min(Min(MAX_LOAD_THREADS, (int)SysInfo.dwNumberOfProcessors), m_iCount);
+
+	//	Start the helper threads. The calling thread does work too.
+
+	TArray<HANDLE> Threads;
+	for (i = 1; i < iThreads; i++)
+		{
+		HANDLE hThread = ::kernelCreateThread(Thread, this);
+		if (hThread)
+			Threads.Insert(hThread);
+		}
+
+	Thread(this);
+
+	//	Wait for the helpers to finish
+
+	if (Threads.GetCount() > 0)
+		::WaitForMultipleObjects(Threads.GetCount(), &Threads[0], TRUE, INFINITE);
+
+	for (i = 0; i < Threads.GetCount(); i++)
+		::CloseHandle(Threads[i]);
+	}
+
+DWORD WINAPI CParallelLoader::Thread (LPVOID pData)
+
+//	Thread
+//
+//	Keep taking the next index until there are none left.
+
+	{
+	CParallelLoader *pThis = (CParallelLoader *)pData;
+
+	while (true)
+		{
+		int iIndex = (int)::InterlockedIncrement(&pThis->m_iNext) - 1;
+		if (iIndex >= pThis->m_iCount)
+			return 0;
+
+		pThis->OnLoad(iIndex);
+		}
+	}
@@ -75,7 +75,10 @@ CParticleArray::~CParticleArray (void)
 
 	{
 	if (m_pArray)
+		{
+		CMemoryStats::Free(CMemoryStats::tagParticles, m_iCount * sizeof(SParticle));
 		delete [] m_pArray;
+		}
 	}
 
 void CParticleArray::AddParticle (const CVector &vPos, const CVector &vVel, int iLifeLeft, int iRotation, int iDestiny, DWORD dwData)
@@ -142,6 +145,7 @@ void CParticleArray::CleanUp (void)
 	{
 	if (m_pArray)
 		{
+		CMemoryStats::Free(CMemoryStats::tagParticles, m_iCount * sizeof(SParticle));
 		delete [] m_pArray;
 		m_pArray = NULL;
 		}
@@ -181,6 +185,7 @@ void CParticleArray::Init (int iMaxCount, const CVector &vOrigin)
 		{
 		m_pArray = new SParticle [iMaxCount];
 		utlMemSet(m_pArray, sizeof(SParticle) * iMaxCount, 0);
+		CMemoryStats::Alloc(CMemoryStats::tagParticles, iMaxCount * sizeof(SParticle));
 
 		m_iCount = iMaxCount;
 		}
@@ -729,6 +734,7 @@ void CParticleArray::ReadFromStream (SLoadCtx &Ctx)
 	//	Load the particles
 
 	m_pArray = new SParticle [m_iCount];
+	CMemoryStats::Alloc(CMemoryStats::tagParticles, m_iCount * sizeof(SParticle));
 	
 	//	Previous version didn't have everything
 
@@ -25,7 +25,9 @@ CResourceDb::CResourceDb (const CString &sFilespec, bool bExtension) :
 		m_sFilespec(sFilespec),
 		m_iVersion(TDB_VERSION),
 		m_pEntities(NULL),
-		m_bFreeEntities(false)
+		m_bFreeEntities(false),
+		m_pCache(NULL),
+		m_bCacheModules(false)
 
 //	CResourceDb constructor
 //
@@ -125,6 +127,9 @@ CResourceDb::~CResourceDb (void)
 	if (m_pDb)
 		delete m_pDb;
 
+	if (m_pCache)
+		delete m_pCache;
+
 	SetEntities(NULL);
 	}
 
@@ -395,22 +400,52 @@ ALERROR CResourceDb::LoadGameFile (CXMLElement **retpData, IXMLParserController
 			return error;
 			}
 
-		//	Parse the XML file from the buffer
-
 		CBufferReadBlock GameFile(sGameFile);
 		CString sError;
 
-		if (error = CXMLElement::ParseXML(&GameFile, pEntities, retpData, &sError, ioEntityTable))
+		//	We can only use the cache if the file does not depend on outside
+		//	entities (otherwise the digest does not cover the result).
+
+		bool bUseCache = (m_pCache && pEntities == NULL);
+		m_bCacheModules = bUseCache;
+
+		//	If we've got it in the cache, then we only need to parse the 
+		//	entities (which are at the top of the file).
+
+		if (bUseCache && m_pCache->Find(m_sGameFile, retpData))
 			{
-			if (retsError)
+			if (ioEntityTable
+					&& (error = CXMLElement::ParseEntityTable(&GameFile, ioEntityTable, &sError)))
 				{
-				if (error == ERR_NOTFOUND)
-					*retsError = strPatternSubst(CONSTLIT("Unable to open file: %s"), m_sGameFile);
-				else
+				delete *retpData;
+				*retpData = NULL;
+
+				if (retsError)
 					*retsError = strPatternSubst(CONSTLIT("%s: %s"), m_sGameFile, sError);
+
+				return error;
 				}
+			}
 
-			return error;
+		//	Otherwise, parse the XML file from the buffer
+
+		else
+			{
+			if (error = CXMLElement::ParseXML(&GameFile, pEntities, retpData, &sError, ioEntityTable))
+				{
+				if (retsError)
+					{
+					if (error == ERR_NOTFOUND)
+						*retsError = strPatternSubst(CONSTLIT("Unable to open file: %s"), m_sGameFile);
+					else
+						*retsError = strPatternSubst(CONSTLIT("%s: %s"), m_sGameFile, sError);
+					}
+
+				return error;
+				}
+
+			if (bUseCache)
+				m_pCache->Add(m_sGameFile, *retpData);
 			}
 		}
 	else
@@ -556,6 +591,12 @@ ALERROR CResourceDb::LoadModule (const CString &sFolder, const CString &sFilenam
 		else
 			sFilespec = sFilename;
 
+		//	See if we have it in the cache
+
+		bool bUseCache = (m_pCache && m_bCacheModules);
+		if (bUseCache && m_pCache->Find(sFilespec, retpData))
+			return NOERROR;
+
 		//	Look up the file in the map
 
 		CString sGameFile;
@@ -575,6 +616,9 @@ ALERROR CResourceDb::LoadModule (const CString &sFolder, const CString &sFilenam
 			*retsError = strPatternSubst(CONSTLIT("%s: %s"), m_sGameFile, sError);
 			return error;
 			}
+
+		if (bUseCache)
+			m_pCache->Add(sFilespec, *retpData);
 		}
 	else
 		{
@@ -720,6 +764,32 @@ ALERROR CResourceDb::Open (DWORD dwFlags, CString *retsError)
 	return NOERROR;
 	}
 
+void CResourceDb::OpenCache (const CString &sCacheFilespec, const CIntegerIP &Digest)
+
+//	OpenCache
+//
+//	Use a cache of parsed XML for this file. Digest is the digest of the file
+//	(from ComputeFileDigest); if the cache was saved for a different digest we
+//	ignore it and build a new one.
+//
+//	We only cache TDB files because the digest of an XML file does not cover
+//	its modules.
+
+	{
+	if (m_pCache)
+		{
+		delete m_pCache;
+		m_pCache = NULL;
+		}
+
+	if (!m_bGameFileInDb || m_pDb == NULL || Digest.IsEmpty())
+		return;
+
+	m_pCache = new CGameFileCache;
+	if (m_pCache->Open(sCacheFilespec, Digest) == NOERROR)
+		kernelDebugLogMessage("Using design cache: %s", sCacheFilespec);
+	}
+
 ALERROR CResourceDb::OpenDb (void)
 
 //	OpenDb
@@ -830,6 +900,26 @@ CString CResourceDb::ResolveFilespec (const CString &sFolder, const CString &sFi
 	return sFilespec;
 	}
 
+ALERROR CResourceDb::SaveCache (void)
+
+//	SaveCache
+//
+//	Saves the cache, if we added anything to it.
+
+	{
+	if (m_pCache == NULL || !m_pCache->IsModified())
+		return NOERROR;
+
+	CString sError;
+	if (m_pCache->Save(&sError) != NOERROR)
+		{
+		kernelDebugLogMessage(sError);
+		return ERR_FAIL;
+		}
+
+	return NOERROR;
+	}
+
 void CResourceDb::SetEntities (IXMLParserController *pEntities, bool bFree)
 
 //	SetEntities
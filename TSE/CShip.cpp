@@ -302,15 +302,36 @@ void CShip::CalcDeviceBonus (void)
 	{
 	int i, j;
 
+	//	Make a list of devices that can enhance other devices. Usually there are
+	//	only a few of these, so this saves us from asking every device about 
+	//	every other device.
+
+	TArray<int> Enhancers;
+	for (i = 0; i < GetDeviceCount(); i++)
+		if (!m_Devices[i].IsEmpty() && m_Devices[i].GetClass()->CanEnhanceDevices())
+			Enhancers.Insert(i);
+
+	//	We build each device's enhancements in a scratch stack. If they match
+	//	what the device already has (the common case) we keep the existing 
+	//	stack (which shots in flight may also be sharing) and reuse the scratch
+	//	stack for the next device. We only allocate when something changed.
+
+	CItemEnhancementStack *pEnhancements = NULL;
+	TArray<CString> EnhancementIDs;
+
 	//	Loop over all devices
 
 	for (i = 0; i < GetDeviceCount(); i++)
 		if (!m_Devices[i].IsEmpty())
 			{
-			//	Keep an enhancement stack for this device
+			//	Reset the scratch stack for this device
 
-			CItemEnhancementStack *pEnhancements = new CItemEnhancementStack;
-			TArray<CString> EnhancementIDs;
+			if (pEnhancements == NULL)
+				pEnhancements = new CItemEnhancementStack;
+			else
+				pEnhancements->DeleteAll();
+
+			EnhancementIDs.DeleteAll();
 
 			//	Add any enhancements on the item itself
 
@@ -325,19 +346,22 @@ void CShip::CalcDeviceBonus (void)
 
 			//	Add enhancements from other devices
 
-			for (j = 0; j < GetDeviceCount(); j++)
-				if (i != j && !m_Devices[j].IsEmpty())
-					{
-					//	See if this device enhances us
+			for (j = 0; j < Enhancers.GetCount(); j++)
+				{
+				int iEnhancer = Enhancers[j];
+				if (iEnhancer == i)
+					continue;
 
-					if (m_Devices[j].AccumulateEnhancements(this, &m_Devices[i], EnhancementIDs, pEnhancements))
-						{
-						//	If the device affected something, then we now know what it is
+				//	See if this device enhances us
 
-						if (IsPlayer())
-							m_Devices[j].GetClass()->GetItemType()->SetKnown();
-						}
+				if (m_Devices[iEnhancer].AccumulateEnhancements(this, &m_Devices[i], EnhancementIDs, pEnhancements))
+					{
+					//	If the device affected something, then we now know what it is
+
+					if (IsPlayer())
+						m_Devices[iEnhancer].GetClass()->GetItemType()->SetKnown();
 					}
+				}
 
 			//	Deal with class specific stuff
 
@@ -375,11 +399,22 @@ void CShip::CalcDeviceBonus (void)
 
 			m_Devices[i].SetActivateDelay(pEnhancements->CalcActivateDelay(CItemCtx(this, &m_Devices[i])));
 
-			//	Take ownership of the stack.
+			//	If nothing changed, keep the current stack.
+
+			CItemEnhancementStack *pOldEnhancements = m_Devices[i].GetEnhancements();
+			if (pOldEnhancements ? pOldEnhancements->IsEqual(*pEnhancements) : pEnhancements->IsEmpty())
+				continue;
+
+			//	Otherwise, the device takes ownership of the stack (we'll allocate
+			//	a new scratch stack for the next device).
 
 			m_Devices[i].SetEnhancements(pEnhancements);
+			pEnhancements = NULL;
 			}
 
+	if (pEnhancements)
+		pEnhancements->Delete();
+
 	//	Make sure we don't overflow fuel (in case we downgrade the reactor)
 
 	if (!m_fOutOfFuel)
@@ -12,6 +12,7 @@
 #define MAX_DISTANCE							(700.0 * g_KlicksPerPixel)
 
 const int AGGRESSOR_THRESHOLD =					(30 * 30);
+const int MAX_LOCAL_NEAREST_ENEMIES =			16;
 
 const int ITEM_UPDATE_CYCLE =					30;
 const int HIGHLIGHT_TIMER =						200;
@@ -29,6 +30,10 @@ const Metric g_rMaxCommsRange2 =				(g_rMaxCommsRange * g_rMaxCommsRange);
 #define BOUNDS_CHECK_DIST 						(256.0 * g_KlicksPerPixel)
 #define BOUNDS_CHECK_DIST2						(BOUNDS_CHECK_DIST * BOUNDS_CHECK_DIST)
 
+#define SWEEP_STEP								(g_KlicksPerPixel)
+#define SWEEP_BOUNDS_MARGIN						(4.0 * g_KlicksPerPixel)
+const Metric SWEEP_BOUNDS_FACTOR =				1.5;
+
 static CObjectClass<CSpaceObject>g_Class(OBJID_CSPACEOBJECT);
 
 #define HIGHLIGHT_CORNER_WIDTH					8
@@ -156,6 +161,7 @@ SInstallItemResultsData INSTALL_ITEM_RESULTS_TABLE[] =
 CSpaceObject *CSpaceObject::m_pObjInUpdate = NULL;
 bool CSpaceObject::m_bObjDestroyed = false;
 
+bool CalcSweepRange (const CVector &vStart, const CVector &vPath, Metric rPathLen2, CSpaceObject *pObj, Metric *retrStart, Metric *retrEnd);
 CString ParseParam (char **ioPos);
 
 CSpaceObject::CSpaceObject (void) : CObject(&g_Class)
@@ -3294,6 +3300,9 @@ int CSpaceObject::GetNearestVisibleEnemies (int iMaxEnemies,
 	int i;
 	Metric rWorstDist2 = rMaxDist * rMaxDist;
 
+	if (iMaxEnemies <= 0)
+		return 0;
+
 	//	Get the sovereign
 
 	CSovereign *pSovereign = GetSovereignToDefend();
@@ -3314,14 +3323,16 @@ int CSpaceObject::GetNearestVisibleEnemies (int iMaxEnemies,
 		rRange2[i] = rRange2[i] * rRange2[i];
 		}
 
-	//	Allocate an array large enough
+	//	Allocate an array large enough. Most callers ask for only a few 
+	//	enemies, so we avoid the allocation in that case.
 
 	struct Entry
 		{
 		CSpaceObject *pObj;
 		Metric rDist2;
 		};
-	Entry *pList = new Entry[iMaxEnemies];
+	Entry LocalList[MAX_LOCAL_NEAREST_ENEMIES];
+	Entry *pList = (iMaxEnemies <= MAX_LOCAL_NEAREST_ENEMIES ? LocalList : new Entry[iMaxEnemies]);
 	int iCount = 0;
 
 	//	If a ship has fired its weapon after this time, then it counts
@@ -3333,23 +3344,27 @@ int CSpaceObject::GetNearestVisibleEnemies (int iMaxEnemies,
 	else
 		iAggressorThreshold = g_pUniverse->GetTicks() - AGGRESSOR_THRESHOLD;
 
-	//	Loop over all enemies
+	//	Loop over all enemies. We check distance first because it is cheap 
+	//	and rejects most objects; the order of the tests does not change the
+	//	result.
 
+	CVector vCenter = GetPos();
 	int iObjCount = ObjList.GetCount();
 	for (i = 0; i < iObjCount; i++)
 		{
 		CSpaceObject *pObj = ObjList.GetObj(i);
 
+		CVector vDist = vCenter - pObj->GetPos();
+		Metric rDist2 = vDist.Length2();
+		if (rDist2 >= rWorstDist2)
+			continue;
+
 		if ((pObj->GetCategory() == catShip 
 					|| ((dwFlags & FLAG_INCLUDE_STATIONS) && pObj->GetCategory() == catStation))
 				&& pObj->CanAttack()
 				&& pObj != this)
 			{
-			CVector vDist = GetPos() - pObj->GetPos();
-			Metric rDist2 = vDist.Length2();
-
-			if (rDist2 < rWorstDist2
-					&& rDist2 < rRange2[pObj->GetDetectionRangeIndex(iPerception)]
+			if (rDist2 < rRange2[pObj->GetDetectionRangeIndex(iPerception)]
 					&& pObj != pExcludeObj
 					&& pObj->GetLastFireTime() > iAggressorThreshold
 					&& !pObj->IsEscortingFriendOf(this))
@@ -3396,7 +3411,8 @@ int CSpaceObject::GetNearestVisibleEnemies (int iMaxEnemies,
 
 	//	Done with list
 
-	delete [] pList;
+	if (pList != LocalList)
+		delete [] pList;
 
 	//	Return the number of enemies found
 
@@ -4094,7 +4110,7 @@ CSpaceObject *CSpaceObject::HitTest (const CVector &vStart,
 	//	Any objects near the beam are then analyzed further to see if
 	//	the beam hit them.
 
-	int j, k;
+	int j;
 	while (GetSystem()->EnumObjectsInBoxHasMore(i) && iShortListCount < iMaxList)
 		{
 		CSpaceObject *pObj = GetSystem()->EnumObjectsInBoxGetNext(i);
@@ -4120,78 +4136,125 @@ CSpaceObject *CSpaceObject::HitTest (const CVector &vStart,
 			}
 		}
 
-	//	Step the object from the start to the current position to see
-	//	if it hit any of the objects in the short list.
+	//	Sweep the path from the start to the current position to see if it hit
+	//	any of the objects in the short list.
 
 	if (iShortListCount > 0)
 		{
-		CVector vTest = vStart;
-		CVector vStep = (GetPos() - vStart) / (Metric)iSteps;
+		CVector vPath = GetPos() - vStart;
+		Metric rPathLen2 = vPath.Length2();
+		Metric rPathLen = sqrt(rPathLen2);
+		CVector vStep = vPath / (Metric)iSteps;
+
+		//	Find the earliest point along the path (as a fraction of the path)
+		//	that is inside some object. For each object we only test the part
+		//	of the path that passes through a circle around the object.
+		//
+		//	NOTE: We never test the end point; we will test it next tick.
 
-		Metric rClosestApproach2 = rThreshold * rThreshold;
-		CVector vClosestPos;
-		CSpaceObject *pClosestHit = NULL;
+		Metric rHitPos = 1.0;
+		CVector vHitPos;
+		CSpaceObject *pHit = NULL;
 
-		for (k = 0; k < iSteps; k++)
+		for (j = 0; j < iShortListCount; j++)
 			{
-			for (j = 0; j < iShortListCount; j++)
+			CSpaceObject *pObj = pShortList[j];
+
+			Metric rStart, rEnd;
+			if (!CalcSweepRange(vStart, vPath, rPathLen2, pObj, &rStart, &rEnd)
+					|| rStart >= rHitPos)
+				continue;
+
+			//	Ships and structures are tested against their image, so we
+			//	step at most a pixel at a time (otherwise we can skip over small
+			//	targets). Other objects (some of which have random hit tests)
+			//	keep the original sample points.
+
+			Metric rT;
+			Metric rStepFrac;
+			if ((pObj->GetScale() == scaleShip || pObj->GetScale() == scaleStructure)
+					&& rPathLen > SWEEP_STEP * iSteps)
 				{
-				if (pShortList[j]->PointInObject(pShortList[j]->GetPos(), vTest))
+				rT = rStart;
+				rStepFrac = SWEEP_STEP / rPathLen;
+				}
+			else
+				{
+				rT = ceil(rStart * iSteps) / iSteps;
+				rStepFrac = 1.0 / iSteps;
+				}
+
+			for (; rT <= rEnd && rT < rHitPos && rT < 1.0; rT += rStepFrac)
+				{
+				CVector vTest = vStart + (vPath * rT);
+				if (pObj->PointInObject(pObj->GetPos(), vTest))
 					{
-					if (retvHitPos)
-						*retvHitPos = vTest;
+					rHitPos = rT;
+					vHitPos = vTest;
+					pHit = pObj;
+					break;
+					}
+				}
+			}
 
-					//	Figure out the direction that the hit came from
+		if (pHit)
+			{
+			if (retvHitPos)
+				*retvHitPos = vHitPos;
 
-					if (retiHitDir)
-						*retiHitDir = VectorToPolar(-vStep, NULL);
+			//	Figure out the direction that the hit came from
 
-					return pShortList[j];
-					}
+			if (retiHitDir)
+				*retiHitDir = VectorToPolar(-vStep, NULL);
+
+			return pHit;
+			}
 
-				//	Calculate proximity
+		//	Calculate proximity. We find the closest approach of the path to
+		//	each enemy. If we got inside the threshold radius for some object
+		//	and we are now farther away, then we reached the closest point.
 
-				if (bCalcProximity
-						&& (pShortList[j]->GetScale() == scaleShip
-							|| pShortList[j]->GetScale() == scaleStructure)
-						&& IsEnemy(pShortList[j])
-						&& pShortList[j]->CanAttack())
+		if (bCalcProximity)
+			{
+			Metric rClosestApproach2 = rThreshold * rThreshold;
+			CVector vClosestPos;
+			CSpaceObject *pClosestHit = NULL;
+
+			for (j = 0; j < iShortListCount; j++)
+				{
+				CSpaceObject *pObj = pShortList[j];
+				if ((pObj->GetScale() == scaleShip || pObj->GetScale() == scaleStructure)
+						&& IsEnemy(pObj)
+						&& pObj->CanAttack())
 					{
-					CVector vDist = vTest - pShortList[j]->GetPos();
-					Metric rDist2 = vDist.Length2();
+					Metric rT = (rPathLen2 > 0.0 ? (pObj->GetPos() - vStart).Dot(vPath) / rPathLen2 : 0.0);
+					CVector vTest = vStart + (vPath * Max(0.0, Min(1.0, rT)));
+					Metric rDist2 = (vTest - pObj->GetPos()).Length2();
 
 					if (rDist2 < rClosestApproach2)
 						{
 						rClosestApproach2 = rDist2;
 						vClosestPos = vTest;
-						pClosestHit = pShortList[j];
+						pClosestHit = pObj;
 						}
 					}
 				}
 
-			//	Next
-
-			vTest = vTest + vStep;
-			}
-
-		//	If we got inside the threshold radius for some object
-		//	check to see if we are now farther away. If so, then we
-		//	reached the closest point.
-
-		if (bCalcProximity && pClosestHit)
-			{
-			CVector vDist = vTest - pClosestHit->GetPos();
-			Metric rDist2 = vDist.Length2();
-
-			if (rDist2 > rClosestApproach2)
+			if (pClosestHit)
 				{
-				if (retvHitPos)
-					*retvHitPos = vClosestPos;
+				CVector vDist = GetPos() - pClosestHit->GetPos();
+				Metric rDist2 = vDist.Length2();
 
-				if (retiHitDir)
-					*retiHitDir = -1;
+				if (rDist2 > rClosestApproach2)
+					{
+					if (retvHitPos)
+						*retvHitPos = vClosestPos;
 
-				return pClosestHit;
+					if (retiHitDir)
+						*retiHitDir = -1;
+
+					return pClosestHit;
+					}
 				}
 			}
 		}
@@ -6844,6 +6907,58 @@ void CSpaceObject::WriteToStream (IWriteStream *pStream)
 	OnWriteToStream(pStream);
 	}
 
+bool CalcSweepRange (const CVector &vStart, const CVector &vPath, Metric rPathLen2, CSpaceObject *pObj, Metric *retrStart, Metric *retrEnd)
+
+//	CalcSweepRange
+//
+//	Computes the part of the path (vStart to vStart + vPath) that passes
+//	through a circle enclosing the object. The range is returned as fractions
+//	of the path, clipped to [0, 1]. Returns FALSE if the path misses the circle.
+//
+//	The circle is larger than the object's bounds because an object's image
+//	can extend a little past them (rounding and rotation offsets). If the
+//	object has no bounds we return the whole path.
+
+	{
+	Metric rBounds = pObj->GetBoundsRadius();
+	if (rBounds <= 0.0)
+		{
+		*retrStart = 0.0;
+		*retrEnd = 1.0;
+		return true;
+		}
+
+	Metric rRadius = (SWEEP_BOUNDS_FACTOR * rBounds) + SWEEP_BOUNDS_MARGIN;
+	CVector vToCenter = pObj->GetPos() - vStart;
+	Metric rCenterDist2 = vToCenter.Length2() - (rRadius * rRadius);
+
+	//	If we're not moving, then we either start inside the circle or not
+
+	if (rPathLen2 <= 0.0)
+		{
+		*retrStart = 0.0;
+		*retrEnd = 0.0;
+		return (rCenterDist2 <= 0.0);
+		}
+
+	//	Solve |vStart + t * vPath - vCenter| = rRadius for t
+
+	Metric rB = vToCenter.Dot(vPath) / rPathLen2;
+	Metric rDisc = (rB * rB) - (rCenterDist2 / rPathLen2);
+	if (rDisc < 0.0)
+		return false;
+
+	Metric rHalfChord = sqrt(rDisc);
+	Metric rStart = Max(0.0, rB - rHalfChord);
+	Metric rEnd = Min(1.0, rB + rHalfChord);
+	if (rStart > rEnd)
+		return false;
+
+	*retrStart = rStart;
+	*retrEnd = rEnd;
+	return true;
+	}
+
 CString ParseParam (char **ioPos)
 	{
 	char *pPos = *ioPos;
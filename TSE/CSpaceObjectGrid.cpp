@@ -4,6 +4,18 @@
 
 #include "PreComp.h"
 
+SSpaceObjectGridEnumerator::~SSpaceObjectGridEnumerator (void)
+
+//	SSpaceObjectGridEnumerator destructor
+
+	{
+	if (pGridIndexList && pGridIndexList != Buffer)
+		{
+		CMemoryStats::Free(CMemoryStats::tagGridQueries, iGridIndexAlloc);
+		delete [] pGridIndexList;
+		}
+	}
+
 CSpaceObjectGrid::CSpaceObjectGrid (int iGridSize, Metric rCellSize, Metric rCellBorder)
 
 //	CSpaceObjectGrid constructor
@@ -48,6 +60,25 @@ void CSpaceObjectGrid::DeleteAll (void)
 	m_Outer.RemoveAll();
 	}
 
+void CSpaceObjectGrid::GetCellRange (const CVector &vUR, const CVector &vLL, RECT *retrcCells)
+
+//	GetCellRange
+//
+//	Returns the range of cells (inclusive) that we need to check to find all
+//	objects in the given box. We expand the box by the cell border so that we
+//	find objects whose center is outside the box. The range may extend past
+//	the grid, in which case the caller must also check m_Outer.
+
+	{
+	CVector vGridLL = vLL - m_vLL - CVector(m_rCellBorder, m_rCellBorder);
+	CVector vGridUR = vUR - m_vLL + CVector(m_rCellBorder, m_rCellBorder);
+
+	retrcCells->left = (int)(vGridLL.GetX() / m_rCellSize);
+	retrcCells->top = (int)(vGridLL.GetY() / m_rCellSize);
+	retrcCells->right = (int)(vGridUR.GetX() / m_rCellSize);
+	retrcCells->bottom = (int)(vGridUR.GetY() / m_rCellSize);
+	}
+
 bool CSpaceObjectGrid::GetGridCoord (const CVector &vPos, int *retx, int *rety)
 
 //	GetGridCoord
@@ -99,19 +130,37 @@ void CSpaceObjectGrid::EnumStart (SSpaceObjectGridEnumerator &i, const CVector &
 	//	so that we can find the objects even if their center is outside
 	//	the input range
 
-	CVector vGridLL = vLL - m_vLL - CVector(m_rCellBorder, m_rCellBorder);
-	CVector vGridUR = vUR - m_vLL + CVector(m_rCellBorder, m_rCellBorder);
-
-	int xStart = (int)(vGridLL.GetX() / m_rCellSize);
-	int yStart = (int)(vGridLL.GetY() / m_rCellSize);
+	RECT rcCells;
+	GetCellRange(vUR, vLL, &rcCells);
 
-	int xEnd = (int)(vGridUR.GetX() / m_rCellSize);
-	int yEnd = (int)(vGridUR.GetY() / m_rCellSize);
+	int xStart = rcCells.left;
+	int yStart = rcCells.top;
+	int xEnd = rcCells.right;
+	int yEnd = rcCells.bottom;
 
-	//	Generate a list of all grid cells to traverse
+	//	Generate a list of all grid cells to traverse. Most queries fit in the
+	//	enumerator's own buffer; we only allocate for large boxes. (We also
+	//	free any list left over if the enumerator is being reused.)
 
 	int iMaxSize = (xEnd - xStart + 1) * (yEnd - yStart + 1);
-	i.pGridIndexList = new CSpaceObjectList * [iMaxSize];
+	if (i.pGridIndexList && i.pGridIndexList != i.Buffer)
+		{
+		CMemoryStats::Free(CMemoryStats::tagGridQueries, i.iGridIndexAlloc);
+		delete [] i.pGridIndexList;
+		}
+
+	if (iMaxSize <= SSpaceObjectGridEnumerator::BUFFER_SIZE)
+		{
+		i.pGridIndexList = i.Buffer;
+		i.iGridIndexAlloc = 0;
+		}
+	else
+		{
+		i.pGridIndexList = new CSpaceObjectList * [iMaxSize];
+		i.iGridIndexAlloc = iMaxSize * sizeof(CSpaceObjectList *);
+		CMemoryStats::Alloc(CMemoryStats::tagGridQueries, i.iGridIndexAlloc);
+		}
+
 	i.iGridIndexCount = 0;
 	bool bOuterAdded = (m_Outer.GetCount() == 0);
 
@@ -298,18 +347,12 @@ void CSpaceObjectGrid::GetObjectsInBox (const CVector &vUR, const CVector &vLL,
 	//	so that we can find the objects even if their center is outside
 	//	the input range
 
-	CVector vGridLL = vLL - m_vLL - CVector(m_rCellBorder, m_rCellBorder);
-	CVector vGridUR = vUR - m_vLL + CVector(m_rCellBorder, m_rCellBorder);
-
-	int xLL = (int)(vGridLL.GetX() / m_rCellSize);
-	int yLL = (int)(vGridLL.GetY() / m_rCellSize);
-
-	int xUR = (int)(vGridUR.GetX() / m_rCellSize);
-	int yUR = (int)(vGridUR.GetY() / m_rCellSize);
+	RECT rcCells;
+	GetCellRange(vUR, vLL, &rcCells);
 
 	bool bCheckOuter = true;
-	for (y = yLL; y <= yUR; y++)
-		for (x = xLL; x <= xUR; x++)
+	for (y = rcCells.top; y <= rcCells.bottom; y++)
+		for (x = rcCells.left; x <= rcCells.right; x++)
 			{
 			CSpaceObjectList *pList;
 			if (x >= 0 && y >= 0 && x < m_iGridSize && y < m_iGridSize)
@@ -333,3 +376,94 @@ void CSpaceObjectGrid::GetObjectsInBox (const CVector &vUR, const CVector &vLL,
 				}
 			}
 	}
+
+void CSpaceObjectGrid::GetObjectsInBoxes (SSpaceObjectGridQuery *pQueries, int iCount)
+
+//	GetObjectsInBoxes
+//
+//	Answers several box queries in one pass: each cell is visited once, even
+//	if it is covered by more than one query, and each object in it is tested
+//	against every query that covers the cell. Results are appended to each
+//	query's list (callers can reuse lists from tick to tick to avoid
+//	allocating).
+
+	{
+	int i, j, k, x, y;
+
+	if (iCount <= 0)
+		return;
+
+	//	Compute the cell range for each query. Most callers only pass a
+	//	handful of queries, so we use a fixed buffer when we can.
+
+	const int BUFFER_SIZE = 16;
+	RECT rcBuffer[BUFFER_SIZE];
+	RECT *pCells = (iCount <= BUFFER_SIZE ? rcBuffer : new RECT [iCount]);
+
+	bool bCheckOuter = false;
+	for (i = 0; i < iCount; i++)
+		{
+		GetCellRange(pQueries[i].vUR, pQueries[i].vLL, &pCells[i]);
+
+		if (pCells[i].left < 0 || pCells[i].top < 0 
+				|| pCells[i].right >= m_iGridSize || pCells[i].bottom >= m_iGridSize)
+			bCheckOuter = true;
+		}
+
+	//	Visit the cells of each query, skipping cells already covered by an
+	//	earlier query (we handled them when we first saw them).
+
+	for (i = 0; i < iCount; i++)
+		{
+		int xStart = Max(0, (int)pCells[i].left);
+		int yStart = Max(0, (int)pCells[i].top);
+		int xEnd = Min(m_iGridSize - 1, (int)pCells[i].right);
+		int yEnd = Min(m_iGridSize - 1, (int)pCells[i].bottom);
+
+		for (y = yStart; y <= yEnd; y++)
+			for (x = xStart; x <= xEnd; x++)
+				{
+				bool bVisited = false;
+				for (j = 0; j < i && !bVisited; j++)
+					bVisited = (x >= pCells[j].left && x <= pCells[j].right && y >= pCells[j].top && y <= pCells[j].bottom);
+
+				if (bVisited)
+					continue;
+
+				CSpaceObjectList &List = GetList(x, y);
+				for (k = 0; k < List.GetCount(); k++)
+					{
+					CSpaceObject *pObj = List.GetObj(k);
+					if (pObj->IsDestroyed())
+						continue;
+
+					//	This cell can only be covered by query i and later.
+
+					for (j = i; j < iCount; j++)
+						if (x >= pCells[j].left && x <= pCells[j].right && y >= pCells[j].top && y <= pCells[j].bottom
+								&& pObj->InBox(pQueries[j].vUR, pQueries[j].vLL))
+							pQueries[j].pResult->FastAdd(pObj);
+					}
+				}
+		}
+
+	//	Objects outside the grid go to every query that extends past it
+
+	if (bCheckOuter)
+		{
+		for (k = 0; k < m_Outer.GetCount(); k++)
+			{
+			CSpaceObject *pObj = m_Outer.GetObj(k);
+			if (pObj->IsDestroyed())
+				continue;
+
+			for (j = 0; j < iCount; j++)
+				if ((pCells[j].left < 0 || pCells[j].top < 0 || pCells[j].right >= m_iGridSize || pCells[j].bottom >= m_iGridSize)
+						&& pObj->InBox(pQueries[j].vUR, pQueries[j].vLL))
+					pQueries[j].pResult->FastAdd(pObj);
+			}
+		}
+
+	if (pCells != rcBuffer)
+		delete [] pCells;
+	}
@@ -393,7 +393,6 @@ struct SLabelEntry
 	int iNewPosition;
 	};
 
-const int STARFIELD_COUNT =						5000;
 const int STARFIELD_DENSITY =					300;	//	Lower is denser (0 is invalid)
 const int MIN_STAR_DISTANCE =					2;
 const int MAX_STAR_DISTANCE =					20;
@@ -423,6 +422,8 @@ const Metric SAME_POS_THRESHOLD2 =						(g_KlicksPerPixel * g_KlicksPerPixel);
 
 const Metric MAP_GRID_SIZE =							3000.0 * LIGHT_SECOND;
 
+const int CATCH_UP_BEHAVIOR_INTERVAL =					4;		//	Non-combat AI runs every N ticks when catching up
+
 bool CalcOverlap (SLabelEntry *pEntries, int iCount);
 void SetLabelBelow (SLabelEntry &Entry, int cyChar);
 void SetLabelLeft (SLabelEntry &Entry, int cyChar);
@@ -436,8 +437,8 @@ CSystem::CSystem (void) : CObject(&g_Class),
 		m_rTimeScale(TIME_SCALE),
 		m_iLastUpdated(-1),
 		m_fInCreate(false),
+		m_fInCatchUp(false),
 		m_fEncounterTableValid(false),
-		m_StarField(sizeof(CStar), STARFIELD_COUNT),
 		m_ObjGrid(GRID_SIZE, CELL_SIZE, CELL_BORDER),
 		m_fEnemiesInLRS(false),
 		m_fEnemiesInSRS(false),
@@ -461,9 +462,9 @@ CSystem::CSystem (CUniverse *pUniv, CTopologyNode *pTopology) : CObject(&g_Class
 		m_iLastUpdated(-1),
 		m_fNoRandomEncounters(false),
 		m_fInCreate(false),
+		m_fInCatchUp(false),
 		m_fEncounterTableValid(false),
 		m_fUseDefaultTerritories(true),
-		m_StarField(sizeof(CStar), STARFIELD_COUNT),
 		m_ObjGrid(GRID_SIZE, CELL_SIZE, CELL_BORDER)
 
 //	CSystem constructor
@@ -537,20 +538,35 @@ ALERROR CSystem::AddToSystem (CSpaceObject *pObj, int *retiIndex)
 
 	//	Reuse a slot first
 
+	int iIndex = -1;
 	for (i = 0; i < m_AllObjects.GetCount(); i++)
 		{
 		if (m_AllObjects.GetObject(i) == NULL)
 			{
 			m_AllObjects.ReplaceObject(i, pObj);
-			if (retiIndex)
-				*retiIndex = i;
-			return NOERROR;
+			iIndex = i;
+			break;
 			}
 		}
 
 	//	If we could not find a free place, add a new object
 
-	return m_AllObjects.AppendObject(pObj, retiIndex);
+	if (iIndex == -1)
+		{
+		ALERROR error;
+		if (error = m_AllObjects.AppendObject(pObj, &iIndex))
+			return error;
+		}
+
+	//	If we're creating the system, then we need to index the object
+
+	if (m_fInCreate)
+		m_CreateGrid.AddObject(iIndex);
+
+	if (retiIndex)
+		*retiIndex = iIndex;
+
+	return NOERROR;
 	}
 
 bool CSystem::AscendObject (CSpaceObject *pObj, CString *retsError)
@@ -598,6 +614,81 @@ bool CSystem::AscendObject (CSpaceObject *pObj, CString *retsError)
 	return true;
 	}
 
+void CSystem::CalcCombatObjects (TArray<bool> *retInCombat)
+
+//	CalcCombatObjects
+//
+//	Used by reduced-fidelity (catch-up) updates. Returns an array (indexed by
+//	object index) that is TRUE for objects that must get full simulation:
+//	weapon fire, objects with a target, objects being targeted, and the 
+//	player.
+
+	{
+	int i;
+
+	retInCombat->DeleteAll();
+	retInCombat->InsertEmpty(GetObjectCount());
+
+	for (i = 0; i < GetObjectCount(); i++)
+		retInCombat->GetAt(i) = false;
+
+	for (i = 0; i < GetObjectCount(); i++)
+		{
+		CSpaceObject *pObj = GetObject(i);
+		if (pObj == NULL || pObj->IsDestroyed())
+			continue;
+
+		//	Weapon fire and the player always get full simulation
+
+		if ((pObj->GetCategory() & (CSpaceObject::catBeam | CSpaceObject::catMissile))
+				|| pObj->IsPlayer())
+			{
+			retInCombat->GetAt(i) = true;
+			continue;
+			}
+
+		//	If this object is targeting something, then both it and its
+		//	target are in combat.
+
+		CItemCtx ItemCtx;
+		CSpaceObject *pTarget = pObj->GetTarget(ItemCtx, true);
+		if (pTarget)
+			{
+			retInCombat->GetAt(i) = true;
+
+			int iTarget = pTarget->GetIndex();
+			if (pTarget->GetSystem() == this && iTarget >= 0 && iTarget < retInCombat->GetCount())
+				retInCombat->GetAt(iTarget) = true;
+			}
+		}
+	}
+
+Metric CSystem::CalcGravityRange (CSpaceObject *pGravityObj)
+
+//	CalcGravityRange
+//
+//	Returns the distance beyond which the gravity of the given object is too
+//	weak to matter.
+
+	{
+	Metric rScaleRadius;
+	Metric r1EAccel = pGravityObj->GetGravity(&rScaleRadius);
+	if (r1EAccel <= 0.0)
+		return 0.0;
+
+	//	We don't care about accelerations less than 1 km/sec^2.
+
+	const Metric MIN_ACCEL = 1.0;
+
+	//	Compute the radius at which the acceleration is the minimum that we 
+	//	care about.
+	//
+	//	minA = A/r^2
+	//	r = sqrt(A/minA) * Earth-radius
+
+	return sqrt(r1EAccel / MIN_ACCEL) * rScaleRadius;
+	}
+
 int CSystem::CalculateLightIntensity (const CVector &vPos, CSpaceObject **retpStar)
 
 //	CalculateLightIntensity
@@ -1582,7 +1673,6 @@ ALERROR CSystem::CreateStarField (int cxFieldWidth, int cyFieldHeight)
 //	Create the system's background star field
 
 	{
-	ALERROR error;
 	int i, j;
 
 	if (g_cxStarField == cxFieldWidth && g_cyStarField == cyFieldHeight)
@@ -1621,8 +1711,7 @@ ALERROR CSystem::CreateStarField (int cxFieldWidth, int cyFieldHeight)
 			if (Star.bBrightStar = (mathRandom(1, 100) <= BRIGHT_STAR_CHANCE))
 				Star.wSpikeColor = CG16bitImage::BlendPixel(0, Star.wColor, 128);
 
-			if (error = m_StarField.AppendStruct(&Star, NULL))
-				return error;
+			m_StarField.Insert(Star);
 			}
 
 	g_cxStarField = cxFieldWidth;
@@ -2582,14 +2671,21 @@ bool CSystem::IsAreaClear (const CVector &vPos, Metric rRadius, DWORD dwFlags, C
 		rSourceExclusionDist2 = rRadius * rRadius;
 		}
 
-	//	Now check against all objects in the system
+	//	Now check against all structures in range. While creating, the grid
+	//	returns only nearby objects; otherwise it returns all objects.
 
-	for (i = 0; i < GetObjectCount(); i++)
+	TArray<CSpaceObject *> Objs;
+	m_CreateGrid.GetObjectsInRange(this, 
+			vPos, 
+			sqrt(rSourceExclusionDist2), 
+			CSystemCreateGrid::FLAG_STRUCTURES_ONLY | ((dwFlags & IAC_FIXED_RADIUS) ? 0 : CSystemCreateGrid::FLAG_ADD_EXCLUSION_RADIUS), 
+			&Objs);
+
+	for (i = 0; i < Objs.GetCount(); i++)
 		{
-		CSpaceObject *pObj = GetObject(i);
+		CSpaceObject *pObj = Objs[i];
 
-		if (pObj 
-				&& pObj->GetScale() == scaleStructure
+		if (pObj->GetScale() == scaleStructure
 				&& (pSourceSovereign == NULL 
 					|| (dwFlags & IAC_INCLUDE_NON_ENEMIES)
 					|| (pObj->GetSovereign() && pObj->GetSovereign()->IsEnemy(pSourceSovereign)))
@@ -2792,16 +2888,25 @@ void CSystem::PaintStarField(CG16bitImage &Dest, const RECT &rcView, CSpaceObjec
 	int xCenter = (int)(pCenter->GetPos().GetX() / rKlicksPerPixel);
 	int yCenter = (int)(pCenter->GetPos().GetY() / rKlicksPerPixel);
 
-	//	Precompute the star distance adj
+	//	Precompute the star distance adj. For each distance we compute the 
+	//	offset to add to a star's position, already wrapped to the field. Star
+	//	coordinates are usually in [0, cxField] and offsets in [0, cxField), so
+	//	a single subtraction wraps the result (instead of a division per star).
 
-	int xDistAdj[MAX_STAR_DISTANCE + 1];
-	int yDistAdj[MAX_STAR_DISTANCE + 1];
-	xDistAdj[0] = 1;
-	yDistAdj[0] = 1;
-	for (i = 1; i < MAX_STAR_DISTANCE + 1; i++)
+	int xDistOffset[MAX_STAR_DISTANCE + 1];
+	int yDistOffset[MAX_STAR_DISTANCE + 1];
+	for (i = 0; i < MAX_STAR_DISTANCE + 1; i++)
 		{
-		xDistAdj[i] = 4 * xCenter / (i * i);
-		yDistAdj[i] = 4 * yCenter / (i * i);
+		int xDistAdj = (i == 0 ? 1 : 4 * xCenter / (i * i));
+		int yDistAdj = (i == 0 ? 1 : 4 * yCenter / (i * i));
+
+		xDistOffset[i] = (-xDistAdj) % cxField;
+		if (xDistOffset[i] < 0)
+			xDistOffset[i] += cxField;
+
+		yDistOffset[i] = yDistAdj % cyField;
+		if (yDistOffset[i] < 0)
+			yDistOffset[i] += cyField;
 		}
 
 	//	Paint each star
@@ -2813,43 +2918,54 @@ void CSystem::PaintStarField(CG16bitImage &Dest, const RECT &rcView, CSpaceObjec
 
 	for (i = 0; i < m_StarField.GetCount(); i++)
 		{
-		CStar *pStar = (CStar *)m_StarField.GetStruct(i);
+		const CStar *pStar = &m_StarField[i];
+
+		//	Cheap (if inaccurate) test to see if the star is brighter than background
+
+		if (wSpaceValue >= pStar->wColor)
+			continue;
 
 		//	Adjust the coordinates of the star based on the position
 		//	of the center and the distance
 
-		int x = (pStar->x - xDistAdj[pStar->wDistance]) % cxField;
-		if (x < 0)
-			x += cxField;
-		int y = (pStar->y + yDistAdj[pStar->wDistance]) % cyField;
-		if (y < 0)
-			y += cyField;
+		//	(Stars created for a larger viewport may need a full modulo.)
+
+		int x = pStar->x + xDistOffset[pStar->wDistance];
+		if (x >= cxField)
+			{
+			x -= cxField;
+			if (x >= cxField)
+				x %= cxField;
+			}
+
+		int y = pStar->y + yDistOffset[pStar->wDistance];
+		if (y >= cyField)
+			{
+			y -= cyField;
+			if (y >= cyField)
+				y %= cyField;
+			}
 
 		//	Blt the star
 
 		WORD *pPixel = pStart + cyRow * y + x;
 
-		//	Cheap (if inaccurate) test to see if the star is brighter than background
-
-		if (wSpaceValue < pStar->wColor)
+		if (pStar->bBrightStar && wSpaceValue < pStar->wSpikeColor)
 			{
-			if (pStar->bBrightStar && wSpaceValue < pStar->wSpikeColor)
+			if (y < cyField - 1)
 				{
-				if (y < cyField - 1)
-					{
-					*(pPixel + 1) = pStar->wSpikeColor;
-					*(pPixel + cyRow) = pStar->wSpikeColor;
-					}
-
-				if (y > 0)
-					{
-					*(pPixel - 1) = pStar->wSpikeColor;
-					*(pPixel - cyRow) = pStar->wSpikeColor;
-					}
+				*(pPixel + 1) = pStar->wSpikeColor;
+				*(pPixel + cyRow) = pStar->wSpikeColor;
 				}
 
-			*pPixel = pStar->wColor;
+			if (y > 0)
+				{
+				*(pPixel - 1) = pStar->wSpikeColor;
+				*(pPixel - cyRow) = pStar->wSpikeColor;
+				}
 			}
+
+		*pPixel = pStar->wColor;
 		}
 	}
 
@@ -3713,17 +3829,20 @@ void CSystem::RemoveObject (SDestroyCtx &Ctx)
 
 		Ctx.pObj->NotifyOnObjDestroyed(Ctx);
 
-		//	Notify other objects in the system
+		//	Notify other objects in the system. We skip objects that cannot
+		//	hold a reference to the destroyed object (not hooked, no object
+		//	data, no subscriptions) since the call would do nothing.
 
 		for (i = 0; i < GetObjectCount(); i++)
 			{
 			CSpaceObject *pObj = GetObject(i);
 
-			if (pObj && pObj != Ctx.pObj)
+			if (pObj && pObj != Ctx.pObj && pObj->NeedsObjDestroyedNotify())
 				{
 				SetProgramState(psOnObjDestroyed, pObj);
 
 				pObj->OnObjDestroyed(Ctx);
+				g_pUniverse->AddObjDestroyedNotify();
 				}
 			}
 
@@ -3810,14 +3929,7 @@ void CSystem::RemoveTimersForObj (CSpaceObject *pObj)
 //	Remove timers for the given object
 
 	{
-	int i;
-
-	for (i = 0; i < GetTimedEventCount(); i++)
-		{
-		CTimedEvent *pEvent = GetTimedEvent(i);
-		if (pEvent->OnObjDestroyed(pObj))
-			pEvent->SetDestroyed();
-		}
+	m_TimedEvents.ObjDestroyed(pObj);
 	}
 
 void CSystem::ResetStarField (void)
@@ -3830,7 +3942,7 @@ void CSystem::ResetStarField (void)
 	g_cxStarField = -1;
 	g_cyStarField = -1;
 
-	m_StarField.RemoveAll();
+	m_StarField.DeleteAll();
 	}
 
 void CSystem::RestartTime (void)
@@ -4301,8 +4413,17 @@ void CSystem::Update (SSystemUpdateCtx &SystemCtx)
 	if (!IsTimeStopped() && (g_pUniverse->GetPlayer() || SystemCtx.bForceEventFiring))
 		m_TimedEvents.Update(m_iTick, this);
 
+	//	If we're catching up, figure out which objects are in combat. Only
+	//	those objects get full simulation (the others think less often).
+
+	TArray<bool> InCombat;
+	if (SystemCtx.bCatchUp)
+		CalcCombatObjects(&InCombat);
+
 	//	Add all objects to the grid so that we can do faster
-	//	hit tests
+	//	hit tests. NOTE: We always add every object that can be hit, even
+	//	when catching up, because objects in combat use the grid to avoid
+	//	walls, check line of fire, and hit things.
 
 	DebugStartTimer();
 	m_ObjGrid.DeleteAll();
@@ -4336,8 +4457,18 @@ void CSystem::Update (SSystemUpdateCtx &SystemCtx)
 
 		if (pObj && !pObj->IsTimeStopped())
 			{
-			SetProgramState(psUpdatingBehavior, pObj);
-			pObj->Behavior(Ctx);
+			//	When catching up, objects not in combat only get to think
+			//	every few ticks. [Objects created this tick are not in the
+			//	array and get full simulation.]
+
+			if (!SystemCtx.bCatchUp
+					|| i >= InCombat.GetCount()
+					|| InCombat[i]
+					|| ((m_iTick + (int)pObj->GetID()) % CATCH_UP_BEHAVIOR_INTERVAL) == 0)
+				{
+				SetProgramState(psUpdatingBehavior, pObj);
+				pObj->Behavior(Ctx);
+				}
 
 			//	Update the objects
 
@@ -4376,10 +4507,34 @@ void CSystem::Update (SSystemUpdateCtx &SystemCtx)
 			}
 		}
 
-	//	Accelerate objects affected by gravity
+	//	Accelerate objects affected by gravity. We find the objects near all
+	//	gravity wells in a single grid pass. The result lists are kept from
+	//	tick to tick so that this does not allocate.
+
+	if (m_GravityObjects.GetCount() > 0)
+		{
+		if (m_GravityResults.GetCount() < m_GravityObjects.GetCount())
+			m_GravityResults.InsertEmpty(m_GravityObjects.GetCount() - m_GravityResults.GetCount());
+
+		m_GravityQueries.DeleteAll();
+		for (i = 0; i < m_GravityObjects.GetCount(); i++)
+			{
+			CSpaceObject *pGravityObj = m_GravityObjects.GetObj(i);
+			Metric rRange = CalcGravityRange(pGravityObj);
+			CVector vRange(rRange, rRange);
+
+			SSpaceObjectGridQuery *pQuery = m_GravityQueries.Insert();
+			pQuery->vUR = pGravityObj->GetPos() + vRange;
+			pQuery->vLL = pGravityObj->GetPos() - vRange;
+			pQuery->pResult = &m_GravityResults[i];
+			pQuery->pResult->RemoveAll();
+			}
 
-	for (i = 0; i < m_GravityObjects.GetCount(); i++)
-		UpdateGravity(Ctx, m_GravityObjects.GetObj(i));
+		m_ObjGrid.GetObjectsInBoxes(&m_GravityQueries[0], m_GravityQueries.GetCount());
+
+		for (i = 0; i < m_GravityObjects.GetCount(); i++)
+			UpdateGravity(Ctx, m_GravityObjects.GetObj(i), m_GravityResults[i]);
+		}
 
 	//	Move all objects. Note: We always move last because we want to
 	//	paint right after a move. Otherwise, when a laser/missile hits
@@ -4445,16 +4600,37 @@ void CSystem::Update (SSystemUpdateCtx &SystemCtx)
 	m_iTick++;
 	}
 
-void CSystem::UpdateExtended (const CTimeSpan &ExtraTime)
+void CSystem::UpdateExtended (const CTimeSpan &ExtraTime, bool bFastCatchUp, DWORD *retdwTime)
 
 //	UpdateExtended
 //
 //	Updates the system for many ticks
+//
+//	If bFastCatchUp is TRUE we do a reduced-fidelity update: nothing is marked
+//	as painted, cosmetic effects are not created, and non-combat AI runs less
+//	often. Hit testing is unchanged.
 
 	{
 	int i;
+	DWORD dwStartTime = ::GetTickCount();
 
 	SSystemUpdateCtx UpdateCtx;
+	UpdateCtx.bCatchUp = bFastCatchUp;
+
+	//	Nobody has seen this system in a while, so nothing should think that
+	//	it was painted.
+
+	if (bFastCatchUp)
+		{
+		for (i = 0; i < GetObjectCount(); i++)
+			{
+			CSpaceObject *pObj = GetObject(i);
+			if (pObj)
+				pObj->ClearPainted();
+			}
+
+		m_fInCatchUp = true;
+		}
 
 	//	Update for a few seconds
 
@@ -4462,6 +4638,8 @@ void CSystem::UpdateExtended (const CTimeSpan &ExtraTime)
 	for (i = 0; i < iTime; i++)
 		Update(UpdateCtx);
 
+	m_fInCatchUp = false;
+
 	//	Give all objects a chance to update
 
 	for (i = 0; i < GetObjectCount(); i++)
@@ -4476,13 +4654,23 @@ void CSystem::UpdateExtended (const CTimeSpan &ExtraTime)
 		}
 
 	SetProgramState(psUpdating);
+
+	//	Timing
+
+	DWORD dwTime = ::GetTickCount() - dwStartTime;
+	if (g_pUniverse->InDebugMode())
+		kernelDebugLogMessage("UpdateExtended %s: %d ticks in %d ms (%s)", m_sName, iTime, dwTime, (bFastCatchUp ? CONSTLIT("fast") : CONSTLIT("full")));
+
+	if (retdwTime)
+		*retdwTime = dwTime;
 	}
 
-void CSystem::UpdateGravity (SUpdateCtx &Ctx, CSpaceObject *pGravityObj)
+void CSystem::UpdateGravity (SUpdateCtx &Ctx, CSpaceObject *pGravityObj, const CSpaceObjectList &Objs)
 
 //	UpdateGravity
 //
-//	Accelerates objects around high-gravity fields
+//	Accelerates objects around high-gravity fields. Objs must include all
+//	objects within CalcGravityRange of pGravityObj.
 
 	{
 	int i;
@@ -4501,24 +4689,11 @@ void CSystem::UpdateGravity (SUpdateCtx &Ctx, CSpaceObject *pGravityObj)
 
 	Metric rTidalKillDist2 = r1EAccel * rScaleRadius2 / TIDAL_KILL_THRESHOLD;
 
-	//	We don't care about accelerations less than 1 km/sec^2.
-
-	const Metric MIN_ACCEL = 1.0;
-
-	//	Compute the radius at which the acceleration is the minimum that we 
-	//	care about.
-	//
-	//	minA = A/r^2
-	//	r = sqrt(A/minA) * Earth-radius
-
-	Metric rMaxDist = sqrt(r1EAccel / MIN_ACCEL) * rScaleRadius;
+	Metric rMaxDist = CalcGravityRange(pGravityObj);
 	Metric rMaxDist2 = rMaxDist * rMaxDist;
 
 	//	Loop over all objects inside the given distance and accelerate them.
 
-	CSpaceObjectList Objs;
-	GetObjectsInBox(pGravityObj->GetPos(), rMaxDist, Objs);
-
 	for (i = 0; i < Objs.GetCount(); i++)
 		{
 		//	Skip objects not affected by gravity
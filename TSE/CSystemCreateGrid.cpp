@@ -0,0 +1,283 @@
+//	CSystemCreateGrid.cpp
+//
+//	CSystemCreateGrid class
+//	Copyright (c) 2015 by Kronosaur Productions, LLC. All Rights Reserved.
+//
+//	While a system is being created we place stations one at a time and each
+//	placement needs to know whether there are other structures (or empty
+//	locations) nearby. Rather than scan all objects in the system for each
+//	candidate position we keep a coarse spatial hash.
+//
+//	Objects are indexed lazily (at query time) because when an object is
+//	added to the system its position and bounds might not be final. Objects
+//	do not move while the system is being created (no updates happen) so we
+//	never need to re-index.
+//
+//	Queries return a superset of the objects/locations in range; callers are
+//	still responsible for the exact distance test.
+
+#include "PreComp.h"
+#include "math.h"
+
+const Metric CELL_SIZE =					(64.0 * LIGHT_SECOND);
+const int MAX_CELL_COORD =					32000;
+
+CSystemCreateGrid::CSystemCreateGrid (void) :
+		m_bActive(false),
+		m_iLocationsIndexed(0),
+		m_rMaxBounds(0.0),
+		m_rMaxExclusion(0.0)
+
+//	CSystemCreateGrid constructor
+
+	{
+	}
+
+void CSystemCreateGrid::AddObject (int iIndex)
+
+//	AddObject
+//
+//	Remembers that an object was added to the system. We index it at the next
+//	query.
+
+	{
+	if (m_bActive)
+		m_PendingObjs.Insert(iIndex);
+	}
+
+void CSystemCreateGrid::CleanUp (void)
+
+//	CleanUp
+//
+//	Frees the index. After this, queries degenerate to full scans.
+
+	{
+	m_bActive = false;
+	m_Cells.DeleteAll();
+	m_PendingObjs.DeleteAll();
+	m_iLocationsIndexed = 0;
+	m_rMaxBounds = 0.0;
+	m_rMaxExclusion = 0.0;
+	}
+
+void CSystemCreateGrid::GetCellRange (const CVector &vPos, Metric rRange, int *retxLL, int *retyLL, int *retxUR, int *retyUR) const
+
+//	GetCellRange
+//
+//	Returns the range of cells (inclusive) that cover the given box.
+
+	{
+	*retxLL = (int)Max(-(Metric)MAX_CELL_COORD, floor((vPos.GetX() - rRange) / CELL_SIZE));
+	*retyLL = (int)Max(-(Metric)MAX_CELL_COORD, floor((vPos.GetY() - rRange) / CELL_SIZE));
+	*retxUR = (int)Min((Metric)MAX_CELL_COORD, floor((vPos.GetX() + rRange) / CELL_SIZE));
+	*retyUR = (int)Min((Metric)MAX_CELL_COORD, floor((vPos.GetY() + rRange) / CELL_SIZE));
+	}
+
+void CSystemCreateGrid::GetCellsInRange (const CVector &vPos, Metric rRange, TArray<SCell *> *retList)
+
+//	GetCellsInRange
+//
+//	Returns all non-empty cells that intersect the given box.
+
+	{
+	int i, x, y;
+
+	int xLL, yLL, xUR, yUR;
+	GetCellRange(vPos, rRange, &xLL, &yLL, &xUR, &yUR);
+
+	//	If the box covers more cells than we have, then it is faster to
+	//	iterate over our cells.
+
+	Metric rBoxCells = (Metric)(xUR - xLL + 1) * (Metric)(yUR - yLL + 1);
+	if (rBoxCells > (Metric)m_Cells.GetCount())
+		{
+		for (i = 0; i < m_Cells.GetCount(); i++)
+			{
+			DWORD dwKey = m_Cells.GetKey(i);
+			int xCell = (short)LOWORD(dwKey);
+			int yCell = (short)HIWORD(dwKey);
+
+			if (xCell >= xLL && xCell <= xUR && yCell >= yLL && yCell <= yUR)
+				retList->Insert(&m_Cells[i]);
+			}
+		}
+
+	//	Otherwise, look up each cell in the box
+
+	else
+		{
+		for (y = yLL; y <= yUR; y++)
+			for (x = xLL; x <= xUR; x++)
+				{
+				SCell *pCell = m_Cells.GetAt(GetCellKey(x, y));
+				if (pCell)
+					retList->Insert(pCell);
+				}
+		}
+	}
+
+void CSystemCreateGrid::GetLocationsInRange (CSystem *pSystem, const CVector &vPos, Metric rRange, TArray<int> *retList)
+
+//	GetLocationsInRange
+//
+//	Returns a list of locations (by index) that might be inside the box of
+//	half-size rRange centered on vPos. If we're not active, we return all
+//	locations.
+
+	{
+	int i, j;
+
+	if (!m_bActive)
+		{
+		for (i = 0; i < pSystem->GetLocationCount(); i++)
+			retList->Insert(i);
+		return;
+		}
+
+	Sync(pSystem);
+
+	TArray<SCell *> Cells;
+	GetCellsInRange(vPos, rRange, &Cells);
+
+	for (i = 0; i < Cells.GetCount(); i++)
+		for (j = 0; j < Cells[i]->Locations.GetCount(); j++)
+			retList->Insert(Cells[i]->Locations[j]);
+	}
+
+void CSystemCreateGrid::GetObjectsInRange (CSystem *pSystem, const CVector &vPos, Metric rRange, DWORD dwFlags, TArray<CSpaceObject *> *retList)
+
+//	GetObjectsInRange
+//
+//	Returns a list of objects that might be inside the box of half-size rRange
+//	centered on vPos. If we're not active, we return all objects.
+
+	{
+	int i, j;
+	bool bStructuresOnly = ((dwFlags & FLAG_STRUCTURES_ONLY) ? true : false);
+
+	if (!m_bActive)
+		{
+		for (i = 0; i < pSystem->GetObjectCount(); i++)
+			{
+			CSpaceObject *pObj = pSystem->GetObject(i);
+			if (pObj && (!bStructuresOnly || pObj->GetScale() == scaleStructure))
+				retList->Insert(pObj);
+			}
+		return;
+		}
+
+	Sync(pSystem);
+
+	//	Expand the range, if necessary
+
+	if (dwFlags & FLAG_ADD_EXCLUSION_RADIUS)
+		rRange = Max(rRange, m_rMaxExclusion);
+
+	if (dwFlags & FLAG_ADD_BOUNDS)
+		rRange += m_rMaxBounds;
+
+	//	Collect
+
+	TArray<SCell *> Cells;
+	GetCellsInRange(vPos, rRange, &Cells);
+
+	for (i = 0; i < Cells.GetCount(); i++)
+		{
+		SCell *pCell = Cells[i];
+
+		for (j = 0; j < pCell->Objs.GetCount(); j++)
+			{
+			const SObjEntry &Entry = pCell->Objs[j];
+
+			//	Skip objects that have since been removed from the system
+			//	(the slot will either be NULL or reused by a different object).
+
+			if (pSystem->GetObject(Entry.iIndex) != Entry.pObj)
+				continue;
+
+			if (bStructuresOnly && !Entry.bStructure)
+				continue;
+
+			retList->Insert(Entry.pObj);
+			}
+		}
+	}
+
+void CSystemCreateGrid::Init (CSystem *pSystem)
+
+//	Init
+//
+//	Start indexing the given system. Any objects already in the system are
+//	indexed at the first query.
+
+	{
+	int i;
+
+	CleanUp();
+	m_bActive = true;
+
+	for (i = 0; i < pSystem->GetObjectCount(); i++)
+		if (pSystem->GetObject(i))
+			m_PendingObjs.Insert(i);
+	}
+
+CSystemCreateGrid::SCell *CSystemCreateGrid::SetCell (const CVector &vPos)
+
+//	SetCell
+//
+//	Returns the cell containing the given position (creating it if necessary).
+
+	{
+	int x, y;
+	GetCellRange(vPos, 0.0, &x, &y, &x, &y);
+
+	return m_Cells.SetAt(GetCellKey(x, y));
+	}
+
+void CSystemCreateGrid::Sync (CSystem *pSystem)
+
+//	Sync
+//
+//	Index any objects and locations added since the last query.
+
+	{
+	int i;
+
+	//	Objects
+
+	for (i = 0; i < m_PendingObjs.GetCount(); i++)
+		{
+		CSpaceObject *pObj = pSystem->GetObject(m_PendingObjs[i]);
+		if (pObj == NULL)
+			continue;
+
+		SObjEntry *pEntry = SetCell(pObj->GetPos())->Objs.Insert();
+		pEntry->iIndex = m_PendingObjs[i];
+		pEntry->pObj = pObj;
+		pEntry->bStructure = (pObj->GetScale() == scaleStructure);
+
+		m_rMaxBounds = Max(m_rMaxBounds, pObj->GetBoundsRadius());
+
+		if (pEntry->bStructure)
+			{
+			//	NOTE: Objects without an encounter type use a default exclusion
+			//	radius of 30 light-seconds (see IsExclusionZoneClear).
+
+			CStationType *pType = pObj->GetEncounterInfo();
+			m_rMaxExclusion = Max(m_rMaxExclusion, (pType ? pType->GetEnemyExclusionRadius() : 30.0 * LIGHT_SECOND));
+			}
+		}
+
+	m_PendingObjs.DeleteAll();
+
+	//	Locations are only ever appended, so we just need to index the new
+	//	ones.
+
+	for (i = m_iLocationsIndexed; i < pSystem->GetLocationCount(); i++)
+		{
+		CLocationDef *pLoc = pSystem->GetLocation(i);
+		SetCell(pLoc->GetOrbit().GetObjectPos())->Locations.Insert(i);
+		}
+
+	m_iLocationsIndexed = pSystem->GetLocationCount();
+	}
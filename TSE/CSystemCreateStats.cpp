@@ -297,6 +297,27 @@ void CSystemCreateStats::AddStationTable (CSystem *pSystem, const CString &sStat
 		}
 	}
 
+void CSystemCreateStats::AddSystemCreateTime (CSystem *pSystem, DWORD dwTime)
+
+//	AddSystemCreateTime
+//
+//	Records how long it took to create the given system.
+
+	{
+	int i;
+
+	SSystemCreateTime *pEntry = m_SystemCreateTimes.Insert();
+	pEntry->sNodeID = (pSystem->GetTopology() ? pSystem->GetTopology()->GetID() : NULL_STR);
+	pEntry->sSystemName = pSystem->GetName();
+	pEntry->iLevel = pSystem->GetLevel();
+	pEntry->dwTime = dwTime;
+
+	pEntry->iObjCount = 0;
+	for (i = 0; i < pSystem->GetObjectCount(); i++)
+		if (pSystem->GetObject(i))
+			pEntry->iObjCount++;
+	}
+
 bool CSystemCreateStats::FindEncounterTable (TArray<CStationTableCache::SEntry> &Src, SEncounterTable **retpTable) const
 
 //	FindEncounterTable
@@ -357,3 +378,19 @@ void CSystemCreateStats::GetLabelAttributes (int iIndex, CString *retsAttribs, i
 	if (retiCount)
 		*retiCount = pEntry->iCount;
 	}
+
+DWORD CSystemCreateStats::GetTotalCreateTime (void) const
+
+//	GetTotalCreateTime
+//
+//	Returns the total time spent creating systems (in milliseconds).
+
+	{
+	int i;
+
+	DWORD dwTotal = 0;
+	for (i = 0; i < m_SystemCreateTimes.GetCount(); i++)
+		dwTotal += m_SystemCreateTimes[i].dwTime;
+
+	return dwTotal;
+	}
@@ -2,9 +2,17 @@
 //
 //	CTimedEventList class
 //	Copyright (c) 2012 by Kronosaur Productions, LLC. All Rights Reserved.
+//
+//	We keep an index of events by the object that they refer to (see
+//	CTimedEvent::GetObjRef) so that we don't have to scan every event whenever
+//	an object is destroyed or its timers are cancelled. The index is keyed on
+//	the object pointer (we never dereference it) and is not saved; we rebuild
+//	it on demand after loading (when object references have been resolved).
 
 #include "PreComp.h"
 
+//#define DEBUG_TIMER_INDEX
+
 CTimedEventList::~CTimedEventList (void)
 
 //	CTimedEvent destructor
@@ -13,6 +21,20 @@ CTimedEventList::~CTimedEventList (void)
 	DeleteAll();
 	}
 
+void CTimedEventList::AddToObjIndex (CTimedEvent *pEvent)
+
+//	AddToObjIndex
+//
+//	Adds the event to the object index
+
+	{
+	CSpaceObject *pObj = pEvent->GetObjRef();
+	if (pObj == NULL)
+		return;
+
+	m_ObjIndex.SetAt((DWORD)pObj)->Insert(pEvent);
+	}
+
 bool CTimedEventList::CancelEvent (CSpaceObject *pObj, bool bInDoEvent)
 
 //	CancelEvent
@@ -23,9 +45,17 @@ bool CTimedEventList::CancelEvent (CSpaceObject *pObj, bool bInDoEvent)
 	int i;
 	bool bFound = false;
 
-	for (i = 0; i < GetCount(); i++)
+	TArray<CTimedEvent *> *pObjEvents = GetObjIndex(pObj);
+	if (pObjEvents == NULL)
+		return false;
+
+	//	Make a copy because removing events modifies the index
+
+	TArray<CTimedEvent *> Events = *pObjEvents;
+
+	for (i = 0; i < Events.GetCount(); i++)
 		{
-		CTimedEvent *pEvent = GetEvent(i);
+		CTimedEvent *pEvent = Events[i];
 		if (pEvent->GetEventHandlerObj() == pObj)
 			{
 			bFound = true;
@@ -33,10 +63,7 @@ bool CTimedEventList::CancelEvent (CSpaceObject *pObj, bool bInDoEvent)
 			if (bInDoEvent)
 				pEvent->SetDestroyed();
 			else
-				{
-				RemoveEvent(i);
-				i--;
-				}
+				RemoveEventPtr(pEvent);
 			}
 		}
 
@@ -53,9 +80,17 @@ bool CTimedEventList::CancelEvent (CSpaceObject *pObj, const CString &sEvent, bo
 	int i;
 	bool bFound = false;
 
-	for (i = 0; i < GetCount(); i++)
+	TArray<CTimedEvent *> *pObjEvents = GetObjIndex(pObj);
+	if (pObjEvents == NULL)
+		return false;
+
+	//	Make a copy because removing events modifies the index
+
+	TArray<CTimedEvent *> Events = *pObjEvents;
+
+	for (i = 0; i < Events.GetCount(); i++)
 		{
-		CTimedEvent *pEvent = GetEvent(i);
+		CTimedEvent *pEvent = Events[i];
 		if (pEvent->GetEventHandlerObj() == pObj 
 				&& strEquals(pEvent->GetEventHandlerName(), sEvent))
 			{
@@ -64,10 +99,7 @@ bool CTimedEventList::CancelEvent (CSpaceObject *pObj, const CString &sEvent, bo
 			if (bInDoEvent)
 				pEvent->SetDestroyed();
 			else
-				{
-				RemoveEvent(i);
-				i--;
-				}
+				RemoveEventPtr(pEvent);
 			}
 		}
 
@@ -87,6 +119,63 @@ void CTimedEventList::DeleteAll (void)
 		delete m_List[i];
 
 	m_List.DeleteAll();
+	m_ObjIndex.DeleteAll();
+	m_bObjIndexValid = false;
+	}
+
+TArray<CTimedEvent *> *CTimedEventList::GetObjIndex (CSpaceObject *pObj)
+
+//	GetObjIndex
+//
+//	Returns the list of events that refer to the given object (or NULL if there
+//	are none). We rebuild the index, if necessary.
+
+	{
+	int i;
+
+	if (!m_bObjIndexValid)
+		{
+		m_ObjIndex.DeleteAll();
+		for (i = 0; i < m_List.GetCount(); i++)
+			AddToObjIndex(m_List[i]);
+
+		m_bObjIndexValid = true;
+		}
+
+	return m_ObjIndex.GetAt((DWORD)pObj);
+	}
+
+void CTimedEventList::ObjDestroyed (CSpaceObject *pObj)
+
+//	ObjDestroyed
+//
+//	The given object has been destroyed. We mark any events that depend on it
+//	as destroyed (they get deleted at the next Update).
+
+	{
+	int i;
+
+	TArray<CTimedEvent *> *pObjEvents = GetObjIndex(pObj);
+	if (pObjEvents)
+		{
+		for (i = 0; i < pObjEvents->GetCount(); i++)
+			{
+			CTimedEvent *pEvent = pObjEvents->GetAt(i);
+			if (pEvent->OnObjDestroyed(pObj))
+				pEvent->SetDestroyed();
+			}
+		}
+
+#ifdef DEBUG_TIMER_INDEX
+	//	Make sure the index did not miss anything
+
+	for (i = 0; i < m_List.GetCount(); i++)
+		if (m_List[i]->OnObjDestroyed(pObj) && !m_List[i]->IsDestroyed())
+			{
+			kernelDebugLogMessage("Timer index missed event: %s", m_List[i]->DebugCrashInfo());
+			ASSERT(false);
+			}
+#endif
 	}
 
 void CTimedEventList::ReadFromStream (SLoadCtx &Ctx)
@@ -102,6 +191,12 @@ void CTimedEventList::ReadFromStream (SLoadCtx &Ctx)
 	int i;
 	DWORD dwCount;
 
+	//	Object references are not resolved until the end of the load, so we
+	//	can't index yet.
+
+	m_ObjIndex.DeleteAll();
+	m_bObjIndexValid = false;
+
 	Ctx.pStream->Read((char *)&dwCount, sizeof(DWORD));
 	for (i = 0; i < (int)dwCount; i++)
 		{
@@ -111,6 +206,55 @@ void CTimedEventList::ReadFromStream (SLoadCtx &Ctx)
 		}
 	}
 
+void CTimedEventList::RemoveEventPtr (CTimedEvent *pEvent)
+
+//	RemoveEventPtr
+//
+//	Removes and deletes the given event
+
+	{
+	int i;
+
+	for (i = 0; i < m_List.GetCount(); i++)
+		if (m_List[i] == pEvent)
+			{
+			RemoveEvent(i);
+			return;
+			}
+	}
+
+void CTimedEventList::RemoveFromObjIndex (CTimedEvent *pEvent)
+
+//	RemoveFromObjIndex
+//
+//	Removes the event from the object index
+
+	{
+	int i;
+
+	if (!m_bObjIndexValid)
+		return;
+
+	CSpaceObject *pObj = pEvent->GetObjRef();
+	if (pObj == NULL)
+		return;
+
+	DWORD dwKey = (DWORD)pObj;
+	TArray<CTimedEvent *> *pObjEvents = m_ObjIndex.GetAt(dwKey);
+	if (pObjEvents == NULL)
+		return;
+
+	for (i = 0; i < pObjEvents->GetCount(); i++)
+		if (pObjEvents->GetAt(i) == pEvent)
+			{
+			pObjEvents->Delete(i);
+			break;
+			}
+
+	if (pObjEvents->GetCount() == 0)
+		m_ObjIndex.DeleteAt(dwKey);
+	}
+
 void CTimedEventList::Update (DWORD dwTick, CSystem *pSystem)
 
 //	Update
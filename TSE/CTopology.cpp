@@ -45,10 +45,11 @@
 #define PREV_DEST								CONSTLIT("[Prev]")
 
 const int DEFAULT_MIN_SEPARATION =				40;
-const int INFINITE_DISTANCE =					2000000000;
-const int UNKNOWN_DISTANCE =					-1;
 
-CTopology::CTopology (void)
+DWORD CTopology::g_dwGateChanges = 0;
+
+CTopology::CTopology (void) :
+		m_dwDistancesGateChanges(0)
 
 //	CTopology constructor
 
@@ -1165,6 +1166,7 @@ ALERROR CTopology::AddTopologyNode (const CString &sID, CTopologyNode *pNode)
 	int iPos = m_Topology.GetCount();
 	m_Topology.Insert(pNode);
 	m_IDToNode.Insert(sID, iPos);
+	InvalidateDistances();
 	return NOERROR;
 	}
 
@@ -1242,6 +1244,48 @@ ALERROR CTopology::AddTopologyNode (STopologyCreateCtx &Ctx,
 	return NOERROR;
 	}
 
+void CTopology::CalcDistancesFrom (int iSource)
+
+//	CalcDistancesFrom
+//
+//	Computes the distance (in gates) from the given node to all other nodes
+//	with a breadth-first search and stores it in m_Distances.
+
+	{
+	int i, j;
+
+	int iCount = GetTopologyNodeCount();
+	int *pRow = &m_Distances[iSource * iCount];
+	for (i = 0; i < iCount; i++)
+		pRow[i] = -1;
+
+	TArray<int> Queue;
+	Queue.Insert(iSource);
+	pRow[iSource] = 0;
+
+	for (i = 0; i < Queue.GetCount(); i++)
+		{
+		CTopologyNode *pNode = GetTopologyNode(Queue[i]);
+		int iNextDist = pRow[Queue[i]] + 1;
+
+		for (j = 0; j < pNode->GetStargateCount(); j++)
+			{
+			CTopologyNode *pDest = pNode->GetStargateDest(j);
+			if (pDest == NULL)
+				continue;
+
+			int *pDestPos = m_IDToNode.GetAt(pDest->GetID());
+			if (pDestPos == NULL || pRow[*pDestPos] != -1)
+				continue;
+
+			pRow[*pDestPos] = iNextDist;
+			Queue.Insert(*pDestPos);
+			}
+		}
+
+	m_DistancesValid[iSource] = true;
+	}
+
 void CTopology::DeleteAll (void)
 
 //	DeleteAll
@@ -1259,6 +1303,7 @@ void CTopology::DeleteAll (void)
 
 	m_Topology.DeleteAll();
 	m_IDToNode.DeleteAll();
+	InvalidateDistances();
 	}
 
 CString CTopology::ExpandNodeID (STopologyCreateCtx &Ctx, const CString &sID)
@@ -1405,138 +1450,42 @@ int CTopology::GetDistance (const CString &sSourceID, const CString &sDestID)
 //
 //	Returns the shortest distance between the two nodes. If there is no path between
 //	the two nodes, we return -1.
+//
+//	We cache the distances from each source node that we've been asked about.
+//	The cache is discarded whenever any node or gate changes.
 
 	{
 	int i;
 
-	if (GetTopologyNodeCount() < 2)
-		return -1;
-
-	//	We mark nodes to track our progress, so we have to save the
-	//	previous value of the marks.
-	//
-	//	We also initialize the calculated distance to UNKNOWN_DISTANCE
-
-	bool *pOldMarks = new bool [GetTopologyNodeCount()];
-	for (i = 0; i < GetTopologyNodeCount(); i++)
-		{
-		pOldMarks[i] = GetTopologyNode(i)->IsMarked();
-		GetTopologyNode(i)->SetMarked(false);
-		GetTopologyNode(i)->SetCalcDistance(UNKNOWN_DISTANCE);
-		}
-
-	//	Find the source node in the list
-
-	CTopologyNode *pSource = FindTopologyNode(sSourceID);
-	if (pSource == NULL)
+	int iCount = GetTopologyNodeCount();
+	if (iCount < 2)
 		return -1;
 
-	//	Find the destination node; We know that it's distance is 0
-
-	CTopologyNode *pDest = FindTopologyNode(sDestID);
-	if (pDest == NULL)
+	int *pSource = m_IDToNode.GetAt(sSourceID);
+	int *pDest = m_IDToNode.GetAt(sDestID);
+	if (pSource == NULL || pDest == NULL)
 		return -1;
 
-	pDest->SetCalcDistance(0);
-
-	//	Loop over all gates and recurse
-
-	int iBestDist = GetDistance(pSource, sDestID, INFINITE_DISTANCE);
-
-	//	Restore
-
-	for (i = 0; i < GetTopologyNodeCount(); i++)
-		GetTopologyNode(i)->SetMarked(pOldMarks[i]);
-	delete pOldMarks;
+	//	If the topology has changed, then we need to start over
 
-	//	Done
-
-	return (iBestDist != INFINITE_DISTANCE ? iBestDist : -1);
-	}
-
-int CTopology::GetDistance (CTopologyNode *pSource, const CString &sDestID, int iBestDist)
-
-//	GetDistance
-//
-//	Returns the distance from pSource to sDestID, using calculated distance
-//	(stored in each topology node).
-//
-//	NOTE: We mark nodes that we are in the middle of evaluating, so that we don't
-//	recurse infinitely. Callers must clear all marks.
-
-	{
-	int i;
-
-	//	If we already know the distance of this node, then we return it.
-
-	int iNewBestDist = pSource->GetCalcDistance();
-	if (iNewBestDist != UNKNOWN_DISTANCE)
-		return iNewBestDist;
-
-	//	If the best distance that we've already calculated is 0, then we fail
-	//	(since we can't get closer than that). This optimizes the algorithm
-	//	so we don't keep evaluating paths that are longer than the best path.
-
-	if (iBestDist == 0)
-		return INFINITE_DISTANCE;
-
-	//	Mark this node so that we don't recurse into it.
-
-	bool bSavedMark = pSource->IsMarked();
-	pSource->SetMarked();
-
-	//	Recursively compute the distance based on any neighboring
-	//	systems.
-
-	bool bDistKnown = true;
-	iNewBestDist = INFINITE_DISTANCE;
-	for (i = 0; i < pSource->GetStargateCount(); i++)
+	if (m_dwDistancesGateChanges != g_dwGateChanges
+			|| m_DistancesValid.GetCount() != iCount)
 		{
-		CTopologyNode *pDest = pSource->GetStargateDest(i);
-		if (pDest == NULL)
-			continue;
-
-		//	Try to calculate the distance, if we can
+		m_Distances.DeleteAll();
+		m_Distances.InsertEmpty(iCount * iCount);
 
-		if (!pDest->IsMarked())
-			{
-			int iDist = GetDistance(pDest, sDestID, iNewBestDist - 1);
-			if (iDist < iNewBestDist)
-				{
-				iNewBestDist = iDist;
-
-				//	Can't get closer than this, so we're done.
-
-				if (iNewBestDist == 0)
-					break;
-				}
-			}
+		m_DistancesValid.DeleteAll();
+		m_DistancesValid.InsertEmpty(iCount);
+		for (i = 0; i < iCount; i++)
+			m_DistancesValid[i] = false;
 
-		//	If the destination node doesn't know its distance, then we can't
-		//	compute our distance either (it means that we're down a dead-end branch
-		//	or something).
-
-		if (pDest->GetCalcDistance() == UNKNOWN_DISTANCE)
-			bDistKnown = false;
+		m_dwDistancesGateChanges = g_dwGateChanges;
 		}
 
-	//	Clear the mark
-
-	pSource->SetMarked(bSavedMark);
-
-	//	Our distance is 1 more than the best distance from any of our neighbors.
-
-	if (iNewBestDist != INFINITE_DISTANCE)
-		iNewBestDist++;
-
-	//	If we have enough information to set our distance, do it now
-
-	if (bDistKnown)
-		pSource->SetCalcDistance(iNewBestDist);
-
-	//	Done
+	if (!m_DistancesValid[*pSource])
+		CalcDistancesFrom(*pSource);
 
-	return iNewBestDist;
+	return m_Distances[*pSource * iCount + *pDest];
 	}
 
 ALERROR CTopology::GetOrAddTopologyNode (STopologyCreateCtx &Ctx, 
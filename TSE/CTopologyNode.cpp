@@ -103,6 +103,7 @@ ALERROR CTopologyNode::AddGateInt (const CString &sName, const CString &sDestNod
 		return error;
 		}
 
+	CTopology::InvalidateDistances();
 	return NOERROR;
 	}
 
@@ -1027,6 +1028,8 @@ void CTopologyNode::SetStargateDest (const CString &sName, const CString &sDestN
 	pDesc->sDestNode = sDestNode;
 	pDesc->sDestEntryPoint = sEntryPoint;
 	pDesc->pDestNode = NULL;
+
+	CTopology::InvalidateDistances();
 	}
 
 void CTopologyNode::WriteToStream (IWriteStream *pStream)
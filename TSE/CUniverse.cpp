@@ -84,6 +84,29 @@ struct SExtensionSaveDesc
 	DWORD dwRelease;
 	};
 
+class CImagePrefetcher : public CParallelLoader
+	{
+	public:
+		CImagePrefetcher (TArray<CObjectImage *> &Images) : CParallelLoader(Images.GetCount()),
+				m_Images(Images)
+			{
+			//	We make private copies of the strings each image needs here, on
+			//	the main thread, so that the helper threads never touch string
+			//	storage shared with anyone else.
+
+			m_Prefetch.InsertEmpty(Images.GetCount());
+			for (int i = 0; i < Images.GetCount(); i++)
+				Images[i]->InitPrefetch(&m_Prefetch[i]);
+			}
+
+	protected:
+		virtual void OnLoad (int iIndex) { m_Images[iIndex]->Prefetch(m_Prefetch[iIndex]); }
+
+	private:
+		TArray<CObjectImage *> &m_Images;
+		TArray<CObjectImage::SPrefetch> m_Prefetch;
+	};
+
 #define STR_G_PLAYER_SHIP					CONSTLIT("gPlayerShip")
 
 const DWORD UNIVERSE_VERSION_MARKER =					0xffffffff;
@@ -142,8 +165,17 @@ CUniverse::CUniverse (void) : CObject(&g_Class),
 		m_pSoundMgr(NULL),
 
 		m_pHost(&g_DefaultHost),
+		m_iDeferImageLoad(0),
+		m_bPrefetchingImages(false),
+		m_iImageLoadStalls(0),
+		m_iItemEventRebuilds(0),
+		m_iLastItemEventRebuilds(0),
+		m_iObjDestroyedNotifies(0),
+		m_iLastObjDestroyedNotifies(0),
 		m_bDebugMode(false),
 		m_bNoSound(false),
+		m_bFastCatchUp(false),
+		m_dwLastCatchUpTime(0),
 		m_iLogImageLoad(0)
 
 //	CUniverse constructor
@@ -250,6 +282,17 @@ ALERROR CUniverse::AddStarSystem (CTopologyNode *pTopology, CSystem *pSystem)
 	return NOERROR;
 	}
 
+void CUniverse::BeginImagePrefetch (void)
+
+//	BeginImagePrefetch
+//
+//	From now until the matching EndImagePrefetch, images that get marked are
+//	not loaded right away. Instead, we load them all at the end, in parallel.
+
+	{
+	m_iDeferImageLoad++;
+	}
+
 ALERROR CUniverse::CreateEmptyStarSystem (CSystem **retpSystem)
 
 //	CreateEmptyStarSystem
@@ -455,8 +498,13 @@ ALERROR CUniverse::CreateStarSystem (CTopologyNode *pTopology, CSystem **retpSys
 
 	CString sError;
 
+	//	Stations mark their images as they are created; we collect them and load
+	//	them all at the end.
+
 	SetLogImageLoad(false);
+	BeginImagePrefetch();
 	error = CSystem::CreateFromXML(this, pSystemType, pTopology, &pSystem, &sError, pStats);
+	EndImagePrefetch();
 	SetLogImageLoad(true);
 
 	if (error)
@@ -511,6 +559,22 @@ void CUniverse::DebugOutput (char *pszLine, ...)
 #endif
 	}
 
+bool CUniverse::DeferImageLoad (CObjectImage *pImage)
+
+//	DeferImageLoad
+//
+//	Called by CObjectImage::Mark. If we're collecting images to prefetch, we
+//	add the image to the list and return TRUE. Otherwise, the caller should
+//	load the image itself.
+
+	{
+	if (m_iDeferImageLoad == 0)
+		return false;
+
+	m_ImagePrefetch.Insert(pImage);
+	return true;
+	}
+
 void CUniverse::DestroySystem (CSystem *pSystem)
 
 //	DestroySystem
@@ -532,6 +596,31 @@ void CUniverse::DestroySystem (CSystem *pSystem)
 		}
 	}
 
+void CUniverse::EndImagePrefetch (void)
+
+//	EndImagePrefetch
+//
+//	Loads all images marked since the outermost BeginImagePrefetch. We block
+//	until all images are loaded, so nothing else can touch them meanwhile.
+
+	{
+	ASSERT(m_iDeferImageLoad > 0);
+	if (--m_iDeferImageLoad > 0 || m_ImagePrefetch.GetCount() == 0)
+		return;
+
+	DWORD dwStart = ::GetTickCount();
+
+	m_bPrefetchingImages = true;
+	CImagePrefetcher Prefetcher(m_ImagePrefetch);
+	Prefetcher.Run();
+	m_bPrefetchingImages = false;
+
+	if (InDebugMode())
+		kernelDebugLogMessage("Prefetched %d images in %d ms.", m_ImagePrefetch.GetCount(), ::GetTickCount() - dwStart);
+
+	m_ImagePrefetch.DeleteAll();
+	}
+
 CArmorClass *CUniverse::FindArmor (DWORD dwUNID)
 
 //	FindArmor
@@ -811,11 +900,34 @@ void CUniverse::GetMissions (CSpaceObject *pSource, const CMission::SCriteria &C
 	int i;
 
 	retList->DeleteAll();
-	for (i = 0; i < m_AllMissions.GetCount(); i++)
+
+	//	If we only want missions owned by the source, then we only need to look
+	//	at those.
+
+	if (Criteria.bOnlySourceOwner)
 		{
-		CMission *pMission = m_AllMissions.GetMission(i);
-		if (pMission->MatchesCriteria(pSource, Criteria))
-			retList->Insert(pMission);
+		const TArray<CMission *> *pOwned = m_AllMissions.GetMissionsByOwner(pSource ? pSource->GetID() : OBJID_NULL);
+		if (pOwned == NULL)
+			return;
+
+		for (i = 0; i < pOwned->GetCount(); i++)
+			{
+			CMission *pMission = pOwned->GetAt(i);
+			if (pMission->MatchesCriteria(pSource, Criteria))
+				retList->Insert(pMission);
+			}
+		}
+
+	//	Otherwise, check all missions
+
+	else
+		{
+		for (i = 0; i < m_AllMissions.GetCount(); i++)
+			{
+			CMission *pMission = m_AllMissions.GetMission(i);
+			if (pMission->MatchesCriteria(pSource, Criteria))
+				retList->Insert(pMission);
+			}
 		}
 	}
 
@@ -1465,6 +1577,23 @@ ALERROR CUniverse::InitRequiredEncounters (CString *retsError)
 	return NOERROR;
 	}
 
+void CUniverse::MarkLibraryBitmaps (void)
+
+//	MarkLibraryBitmaps
+//
+//	Marks (and loads) all images needed by global types and by the current
+//	system. Images that are not yet loaded are loaded in parallel.
+
+	{
+	BeginImagePrefetch();
+
+	m_Design.MarkGlobalImages();
+	if (m_pCurrentSystem)
+		m_pCurrentSystem->MarkImages();
+
+	EndImagePrefetch();
+	}
+
 void CUniverse::NotifyMissionsOfNewSystem (CSystem *pSystem)
 
 //	NotifyMissionsOfNewSystem
@@ -1957,6 +2086,39 @@ void CUniverse::PaintPOV (CG16bitImage &Dest, const RECT &rcView, DWORD dwFlags)
 	m_iPaintTick++;
 	}
 
+ALERROR CUniverse::PaintPOVToFile (const CString &sFilespec, int cxWidth, int cyHeight, DWORD dwFlags, CString *retsError)
+
+//	PaintPOVToFile
+//
+//	Paints the current point of view to an offscreen image and saves it as a
+//	bitmap. This does not need a window, so it can be used to capture frames
+//	for regression comparison.
+
+	{
+	if (m_pPOV == NULL)
+		{
+		if (retsError) *retsError = CONSTLIT("No point of view.");
+		return ERR_FAIL;
+		}
+
+	CG16bitImage Frame;
+	if (Frame.CreateBlank(cxWidth, cyHeight, false) != NOERROR)
+		{
+		if (retsError) *retsError = CONSTLIT("Unable to create frame image.");
+		return ERR_FAIL;
+		}
+
+	RECT rcView;
+	rcView.left = 0;
+	rcView.top = 0;
+	rcView.right = cxWidth;
+	rcView.bottom = cyHeight;
+
+	PaintPOV(Frame, rcView, dwFlags);
+
+	return WriteImageAsBMP(Frame, sFilespec, retsError);
+	}
+
 void CUniverse::PaintPOVLRS (CG16bitImage &Dest, const RECT &rcView, bool *retbNewEnemies)
 
 //	PaintPOVLRS
@@ -2489,10 +2651,17 @@ void CUniverse::SetPOV (CSpaceObject *pPOV)
 
 	m_pPOV = pPOV;
 
+	CSystem *pOldSystem = m_pCurrentSystem;
 	if (m_pPOV)
 		SetCurrentSystem(m_pPOV->GetSystem());
 	else
 		SetCurrentSystem(NULL);
+
+	//	If we've entered a different system, load its images now rather than
+	//	one at a time as we first paint them.
+
+	if (m_pCurrentSystem && m_pCurrentSystem != pOldSystem)
+		MarkLibraryBitmaps();
 	}
 
 void CUniverse::StartGame (bool bNewGame)
@@ -2586,6 +2755,13 @@ void CUniverse::Update (SSystemUpdateCtx &Ctx)
 
 	m_Design.FireOnGlobalUpdate(m_iTick);
 
+	//	Performance counters
+
+	m_iLastItemEventRebuilds = m_iItemEventRebuilds;
+	m_iItemEventRebuilds = 0;
+	m_iLastObjDestroyedNotifies = m_iObjDestroyedNotifies;
+	m_iObjDestroyedNotifies = 0;
+
 	//	Next
 
 	m_iTick++;
@@ -2612,7 +2788,7 @@ void CUniverse::UpdateExtended (void)
 
 	//	Update the system 
 
-	pSystem->UpdateExtended(TotalTime);
+	pSystem->UpdateExtended(TotalTime, m_bFastCatchUp, &m_dwLastCatchUpTime);
 	}
 
 void CUniverse::UpdateMissions (int iTick, CSystem *pSystem)
@@ -2797,11 +2797,12 @@ bool CheckForOverlap (SSystemCreateCtx *pCtx, const CVector &vPos)
 	CVector vUR(vPos.GetX() + OVERLAP_DIST, vPos.GetY() + OVERLAP_DIST);
 	CVector vLL(vPos.GetX() - OVERLAP_DIST, vPos.GetY() - OVERLAP_DIST);
 
-	for (i = 0; i < pCtx->pSystem->GetObjectCount(); i++)
-		{
-		CSpaceObject *pObj = pCtx->pSystem->GetObject(i);
+	TArray<CSpaceObject *> Objs;
+	pCtx->pSystem->GetCreateGrid().GetObjectsInRange(pCtx->pSystem, vPos, OVERLAP_DIST, CSystemCreateGrid::FLAG_ADD_BOUNDS, &Objs);
 
-		if (pObj && pObj->InBox(vUR, vLL))
+	for (i = 0; i < Objs.GetCount(); i++)
+		{
+		if (Objs[i]->InBox(vUR, vLL))
 			return true;
 		}
 
@@ -3236,16 +3237,18 @@ bool IsExclusionZoneClear (SSystemCreateCtx *pCtx, const CVector &vPos, Metric r
 	{
 	int j;
 	Metric rExclusionDist2 = rRadius * rRadius;
+	CSystemCreateGrid &Grid = pCtx->pSystem->GetCreateGrid();
 
 	//	See if we are close to any objects
 
-	for (j = 0; j < pCtx->pSystem->GetObjectCount(); j++)
+	TArray<CSpaceObject *> Objs;
+	Grid.GetObjectsInRange(pCtx->pSystem, vPos, rRadius, CSystemCreateGrid::FLAG_STRUCTURES_ONLY, &Objs);
+
+	for (j = 0; j < Objs.GetCount(); j++)
 		{
-		CSpaceObject *pObj = pCtx->pSystem->GetObject(j);
+		CSpaceObject *pObj = Objs[j];
 
-		if (pObj 
-				&& pObj->GetScale() == scaleStructure
-				&& pObj->CanAttack())
+		if (pObj->CanAttack())
 			{
 			//	Compute the distance to this obj
 
@@ -3261,11 +3264,14 @@ bool IsExclusionZoneClear (SSystemCreateCtx *pCtx, const CVector &vPos, Metric r
 
 	//	See if we are close to any labels
 
-	TArray<int> EmptyLocations;
-	pCtx->pSystem->GetEmptyLocations(&EmptyLocations);
-	for (j = 0; j < EmptyLocations.GetCount(); j++)
+	TArray<int> Locations;
+	Grid.GetLocationsInRange(pCtx->pSystem, vPos, rRadius, &Locations);
+	for (j = 0; j < Locations.GetCount(); j++)
 		{
-		CLocationDef *pLoc = pCtx->pSystem->GetLocation(EmptyLocations[j]);
+		CLocationDef *pLoc = pCtx->pSystem->GetLocation(Locations[j]);
+		if (!pLoc->IsEmpty())
+			continue;
+
 		CVector vDist = vPos - pLoc->GetOrbit().GetObjectPos();
 		Metric rDist2 = vDist.Length2();
 
@@ -3291,13 +3297,18 @@ bool IsExclusionZoneClear (SSystemCreateCtx *pCtx, const CVector &vPos, CStation
 	Metric rExclusionDist2 = pType->GetEnemyExclusionRadius();
 	rExclusionDist2 *= rExclusionDist2;
 
-	for (j = 0; j < pCtx->pSystem->GetObjectCount(); j++)
+	TArray<CSpaceObject *> Objs;
+	pCtx->pSystem->GetCreateGrid().GetObjectsInRange(pCtx->pSystem, 
+			vPos, 
+			pType->GetEnemyExclusionRadius(), 
+			CSystemCreateGrid::FLAG_STRUCTURES_ONLY | CSystemCreateGrid::FLAG_ADD_EXCLUSION_RADIUS, 
+			&Objs);
+
+	for (j = 0; j < Objs.GetCount(); j++)
 		{
-		CSpaceObject *pObj = pCtx->pSystem->GetObject(j);
+		CSpaceObject *pObj = Objs[j];
 
-		if (pObj 
-				&& pObj->GetScale() == scaleStructure
-				&& pObj->GetSovereign()
+		if (pObj->GetSovereign()
 				&& pObj->GetSovereign()->IsEnemy(pSovereign))
 			{
 			//	Compute the distance to this obj
@@ -3486,6 +3497,8 @@ ALERROR CSystem::CreateFromXML (CUniverse *pUniv,
 
 	START_STRESS_TEST;
 
+	DWORD dwStartTime = ::GetTickCount();
+
 	CSystem *pSystem;
 	if (error = CreateEmpty(pUniv, pTopology, &pSystem))
 		{
@@ -3497,6 +3510,7 @@ ALERROR CSystem::CreateFromXML (CUniverse *pUniv,
 	//	System is being created
 
 	pSystem->m_fInCreate = true;
+	pSystem->m_CreateGrid.Init(pSystem);
 
 	//	Load some data
 
@@ -3649,6 +3663,7 @@ ALERROR CSystem::CreateFromXML (CUniverse *pUniv,
 	//	Done creating
 
 	pSystem->m_fInCreate = false;
+	pSystem->m_CreateGrid.CleanUp();
 
 	//	Arrange all map labels so that they don't overlap
 
@@ -3685,6 +3700,11 @@ ALERROR CSystem::CreateFromXML (CUniverse *pUniv,
 			DumpDebugStack(&Ctx);
 			}
 
+	//	Record how long it took
+
+	if (pStats)
+		pStats->AddSystemCreateTime(pSystem, ::GetTickCount() - dwStartTime);
+
 	//	Done
 
 	*retpSystem = pSystem;
@@ -288,3 +288,81 @@ void DrawParticle (CG16bitImage &Dest,
 			}
 		}
 	}
+
+ALERROR WriteImageAsBMP (CG16bitImage &Image, const CString &sFilespec, CString *retsError)
+
+//	WriteImageAsBMP
+//
+//	Writes the image to a 24-bit uncompressed Windows bitmap file. We write the
+//	file ourselves (rather than going through a DC) so that this works without
+//	a window or display.
+
+	{
+	int x, y;
+
+	int cxWidth = Image.GetWidth();
+	int cyHeight = Image.GetHeight();
+	if (cxWidth <= 0 || cyHeight <= 0)
+		{
+		if (retsError) *retsError = CONSTLIT("Image is empty.");
+		return ERR_FAIL;
+		}
+
+	//	Rows are padded to a DWORD boundary
+
+	int iRowSize = AlignUp(cxWidth * 3, sizeof(DWORD));
+	int iImageSize = iRowSize * cyHeight;
+
+	BITMAPFILEHEADER FileHeader;
+	utlMemSet(&FileHeader, sizeof(FileHeader), 0);
+	FileHeader.bfType = 0x4D42;					//	'BM'
+	FileHeader.bfOffBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
+	FileHeader.bfSize = FileHeader.bfOffBits + iImageSize;
+
+	BITMAPINFOHEADER InfoHeader;
+	utlMemSet(&InfoHeader, sizeof(InfoHeader), 0);
+	InfoHeader.biSize = sizeof(BITMAPINFOHEADER);
+	InfoHeader.biWidth = cxWidth;
+	InfoHeader.biHeight = cyHeight;
+	InfoHeader.biPlanes = 1;
+	InfoHeader.biBitCount = 24;
+	InfoHeader.biCompression = BI_RGB;
+	InfoHeader.biSizeImage = iImageSize;
+
+	//	Write
+
+	CFileWriteStream File(sFilespec);
+	if (File.Create() != NOERROR)
+		{
+		if (retsError) *retsError = strPatternSubst(CONSTLIT("Unable to create file: %s."), sFilespec);
+		return ERR_FAIL;
+		}
+
+	File.Write((char *)&FileHeader, sizeof(FileHeader));
+	File.Write((char *)&InfoHeader, sizeof(InfoHeader));
+
+	//	Bitmaps are stored bottom-up
+
+	TArray<BYTE> Row;
+	Row.InsertEmpty(iRowSize);
+	utlMemSet(&Row[0], iRowSize, 0);
+
+	for (y = cyHeight - 1; y >= 0; y--)
+		{
+		WORD *pSrc = Image.GetRowStart(y);
+		BYTE *pDest = &Row[0];
+
+		for (x = 0; x < cxWidth; x++)
+			{
+			*pDest++ = (BYTE)CG16bitImage::BlueValue(pSrc[x]);
+			*pDest++ = (BYTE)CG16bitImage::GreenValue(pSrc[x]);
+			*pDest++ = (BYTE)CG16bitImage::RedValue(pSrc[x]);
+			}
+
+		File.Write((char *)&Row[0], iRowSize);
+		}
+
+	File.Close();
+
+	return NOERROR;
+	}
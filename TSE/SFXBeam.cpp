@@ -228,7 +228,9 @@ void CBeamEffectCreator::DrawBeamJaggedBolt (CG16bitImage &Dest, SLineDesc &Line
 		if (Pixel.dwOpacity != 255)
 			dwOpacity = dwOpacity * Pixel.dwOpacity / 255;
 
-		if (dwOpacity == 255)
+		if (dwOpacity == 0)
+			;
+		else if (dwOpacity == 255)
 			*(Pixel.pPos) = m_wPrimaryColor;
 		else
 			{
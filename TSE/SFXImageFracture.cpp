@@ -6,15 +6,15 @@
 
 #define IMAGE_TAG								(CONSTLIT("Image"))
 
-ALERROR CImageFractureEffectCreator::CreateEffect (CSystem *pSystem,
-												   CSpaceObject *pAnchor,
-												   const CVector &vPos,
-												   const CVector &vVel,
-												   int iRotation,
-												   int iVariant,
-												   CSpaceObject **retpEffect)
-
-//	CreateEffect
+ALERROR CImageFractureEffectCreator::OnCreateEffect (CSystem *pSystem,
+												     CSpaceObject *pAnchor,
+												     const CVector &vPos,
+												     const CVector &vVel,
+												     int iRotation,
+												     int iVariant,
+												     CSpaceObject **retpEffect)
+
+//	OnCreateEffect
 //
 //	Creates the effect object
 
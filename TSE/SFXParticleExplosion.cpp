@@ -11,15 +11,15 @@
 #define PARTICLE_LIFETIME_ATTRIB				(CONSTLIT("particleLifetime"))
 #define LIFETIME_ATTRIB							(CONSTLIT("lifetime"))
 
-ALERROR CParticleExplosionEffectCreator::CreateEffect (CSystem *pSystem,
-													   CSpaceObject *pAnchor,
-													   const CVector &vPos,
-													   const CVector &vVel,
-													   int iRotation,
-													   int iVariant,
-													   CSpaceObject **retpEffect)
-
-//	CreateEffect
+ALERROR CParticleExplosionEffectCreator::OnCreateEffect (CSystem *pSystem,
+													     CSpaceObject *pAnchor,
+													     const CVector &vPos,
+													     const CVector &vVel,
+													     int iRotation,
+													     int iVariant,
+													     CSpaceObject **retpEffect)
+
+//	OnCreateEffect
 //
 //	Creates the effect object
 
@@ -1123,6 +1123,12 @@ void CRayEffectPainter::PaintRay (CG16bitImage &Dest, int xFrom, int yFrom, int
 	if (dwOpacity == 0)
 		return;
 
+	//	Most styles use a single row for the color and opacity maps, so we
+	//	look those up once instead of for each pixel.
+
+	const BYTE *pOpacityRow = (m_OpacityMap.GetCount() == 1 && m_iWidthCount > 0 ? &m_OpacityMap[0][0] : NULL);
+	const WORD *pColorRow = (m_ColorMap.GetCount() == 1 && m_iWidthCount > 0 ? &m_ColorMap[0][0] : NULL);
+
 	//	Loop over all pixels and fill them in
 
 	for (i = 0; i < Pixels.GetCount(); i++)
@@ -1175,21 +1181,31 @@ void CRayEffectPainter::PaintRay (CG16bitImage &Dest, int xFrom, int yFrom, int
 
 		//	Adjust opacity, if necessary
 
-		if (m_OpacityMap.GetCount() == 1)
-			Pixel.dwOpacity = m_OpacityMap[0][w];
+		if (pOpacityRow)
+			Pixel.dwOpacity = pOpacityRow[w];
 
 		else if (m_OpacityMap.GetCount() > 1)
 			Pixel.dwOpacity = m_OpacityMap[v][w];
 
+		//	Apply opacity, if necessary
+
+		if (dwOpacity != 255)
+			Pixel.dwOpacity = Pixel.dwOpacity * dwOpacity / 255;
+
+		//	Transparent pixels don't need a color
+
+		if (Pixel.dwOpacity == 0)
+			continue;
+
 		//	Compute color
 
 		WORD wColor;
-		if (m_ColorMap.GetCount() == 1)
+		if (pColorRow)
 			{
-			wColor = m_ColorMap[0][w];
+			wColor = pColorRow[w];
 			if (w > 0)
 				{
-				WORD wAAColor = m_ColorMap[0][w - 1];
+				WORD wAAColor = pColorRow[w - 1];
 				wColor = CG16bitImage::BlendPixel(wAAColor, wColor, (DWORD)(255.0 * (rW - (Metric)w)));
 				}
 			}
@@ -1200,16 +1216,9 @@ void CRayEffectPainter::PaintRay (CG16bitImage &Dest, int xFrom, int yFrom, int
 		else
 			wColor = m_wPrimaryColor;
 
-		//	Apply opacity, if necessary
-
-		if (dwOpacity != 255)
-			Pixel.dwOpacity = Pixel.dwOpacity * dwOpacity / 255;
-
 		//	Draw
 
-		if (Pixel.dwOpacity == 0)
-			;
-		else if (Pixel.dwOpacity == 255)
+		if (Pixel.dwOpacity == 255)
 			*(Pixel.pPos) = wColor;
 		else
 			{
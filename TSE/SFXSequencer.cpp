@@ -13,15 +13,15 @@ CEffectSequencerCreator::~CEffectSequencerCreator (void)
 		delete m_Timeline[i].pCreator;
 	}
 
-ALERROR CEffectSequencerCreator::CreateEffect (CSystem *pSystem,
-											   CSpaceObject *pAnchor,
-											   const CVector &vPos,
-											   const CVector &vVel,
-											   int iRotation,
-											   int iVariant,
-											   CSpaceObject **retpEffect)
-
-//	CreateEffect
+ALERROR CEffectSequencerCreator::OnCreateEffect (CSystem *pSystem,
+											     CSpaceObject *pAnchor,
+											     const CVector &vPos,
+											     const CVector &vVel,
+											     int iRotation,
+											     int iVariant,
+											     CSpaceObject **retpEffect)
+
+//	OnCreateEffect
 //
 //	Creates the effect
 
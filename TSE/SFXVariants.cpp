@@ -70,15 +70,15 @@ CEffectVariantCreator::SEntry *CEffectVariantCreator::ChooseVariant (int iVarian
 	return &m_Effects[m_Effects.GetCount() - 1];
 	}
 
-ALERROR CEffectVariantCreator::CreateEffect (CSystem *pSystem,
-										   CSpaceObject *pAnchor,
-										   const CVector &vPos,
-										   const CVector &vVel,
-										   int iRotation,
-										   int iVariant,
-										   CSpaceObject **retpEffect)
-
-//	CreateEffect
+ALERROR CEffectVariantCreator::OnCreateEffect (CSystem *pSystem,
+										     CSpaceObject *pAnchor,
+										     const CVector &vPos,
+										     const CVector &vVel,
+										     int iRotation,
+										     int iVariant,
+										     CSpaceObject **retpEffect)
+
+//	OnCreateEffect
 //
 //	Creates an effect object
 
@@ -2,15 +2,26 @@
 //
 //	CBackgroundProcessir class
 //	Copyright (c) 2010 by George Moromisato. All Rights Reserved.
+//
+//	The processor runs a pool of worker threads (one per processor by default).
+//	All workers pull from a single queue ordered by priority (and then by the
+//	order in which tasks were added). Tasks that do not declare themselves
+//	concurrent (see IHITask::OnCanRunConcurrently) are still run one at a time
+//	relative to each other, just as when we only had a single thread.
 
 #include "stdafx.h"
 
-void CBackgroundProcessor::AddTask (IHITask *pTask, IHICommand *pListener, const CString &sCmd)
+const int MAX_WORKERS =							8;
+
+DWORD CBackgroundProcessor::AddTask (IHITask *pTask, IHICommand *pListener, const CString &sCmd, int iPriority)
 
 //	AddTask
 //
 //	Adds a task to the background. We take ownership of pTask.
 //	This is called on the foreground thread.
+//
+//	We return an ID for the task, which may be used to cancel the task or to
+//	query its progress. We return 0 if the task failed to initialize.
 
 	{
 	CSmartLock Lock(m_cs);
@@ -19,34 +30,184 @@ void CBackgroundProcessor::AddTask (IHITask *pTask, IHICommand *pListener, const
 
 	CString sError;
 	if (pTask->HIInit(&sError) != NOERROR)
-		return;
+		return 0;
 
 	STask *pNewTask = m_Tasks.Insert();
 	pNewTask->iStatus = statusReady;
+	pNewTask->dwID = m_dwNextID++;
+	pNewTask->iPriority = iPriority;
+	pNewTask->bExclusive = !pTask->HICanRunConcurrently();
 	pNewTask->pTask = pTask;
 	pNewTask->pListener = pListener;
 	pNewTask->sCmd = (sCmd.IsBlank() ? CONSTLIT("cmdTaskDone") : sCmd);
 
-	::SetEvent(m_hWorkAvailableEvent);
+	UpdateWorkAvailable();
+
+	return pNewTask->dwID;
+	}
+
+bool CBackgroundProcessor::CancelTask (DWORD dwID)
+
+//	CancelTask
+//
+//	Cancels the given task. If the task has not yet started, we remove it (and
+//	the listener is never called). If the task is running, we signal its stop
+//	event; the listener is still called when the task returns.
+//
+//	Returns FALSE if the task is not found.
+
+	{
+	CSmartLock Lock(m_cs);
+	int i;
+
+	for (i = 0; i < m_Tasks.GetCount(); i++)
+		if (m_Tasks[i].dwID == dwID)
+			{
+			if (m_Tasks[i].iStatus == statusReady)
+				{
+				IHITask *pTask = m_Tasks[i].pTask;
+				m_Tasks.Delete(i);
+
+				pTask->HICleanUp();
+				delete pTask;
+
+				UpdateWorkAvailable();
+				if (m_Tasks.GetCount() == 0 && m_iExecuting == 0)
+					PostOnAllTasksComplete();
+				}
+			else
+				{
+				for (i = 0; i < m_Workers.GetCount(); i++)
+					if (m_Workers[i]->GetTaskID() == dwID)
+						m_Workers[i]->Cancel();
+				}
+
+			return true;
+			}
+
+	return false;
 	}
 
 void CBackgroundProcessor::CleanUp (void)
 
 //	CleanUp
 //
-//	Terminate the thread
+//	Terminate the threads
 
 	{
+	int i;
+
 	if (IsInitialized())
 		{
+		m_cs.Lock();
 		::SetEvent(m_hQuitEvent);
-		::WaitForSingleObject(m_hBackgroundThread, INFINITE);
-		m_hBackgroundThread = INVALID_HANDLE_VALUE;
+		for (i = 0; i < m_Workers.GetCount(); i++)
+			m_Workers[i]->Cancel();
+		m_cs.Unlock();
 
+		for (i = 0; i < m_Workers.GetCount(); i++)
+			{
+			m_Workers[i]->CleanUp();
+			delete m_Workers[i];
+			}
+
+		m_Workers.DeleteAll();
+		}
+
+	//	We close the events even if we never got any workers running (e.g.,
+	//	if the first worker failed to initialize).
+
+	if (m_hWorkAvailableEvent)
+		{
 		::CloseHandle(m_hWorkAvailableEvent);
+		m_hWorkAvailableEvent = NULL;
+		}
+
+	if (m_hQuitEvent)
+		{
 		::CloseHandle(m_hQuitEvent);
-		::CloseHandle(m_hBackgroundThread);
+		m_hQuitEvent = NULL;
+		}
+	}
+
+bool CBackgroundProcessor::DequeueTask (CWorker *pWorker, STask *retTask)
+
+//	DequeueTask
+//
+//	Picks the next task for the given worker. We pick the highest priority task
+//	that we're allowed to run (and the oldest task among those with the same
+//	priority).
+//
+//	Returns FALSE if there is nothing to run.
+
+	{
+	CSmartLock Lock(m_cs);
+	int i;
+
+	//	If we're quitting, then nothing to do (we check this under the lock so
+	//	that we don't race with StopAll).
+
+	if (IsStopSignalled())
+		return false;
+
+	int iBest = -1;
+	for (i = 0; i < m_Tasks.GetCount(); i++)
+		{
+		const STask &Task = m_Tasks[i];
+		if (Task.iStatus != statusReady
+				|| (Task.bExclusive && m_iExclusiveRunning > 0))
+			continue;
+
+		if (iBest == -1 || Task.iPriority > m_Tasks[iBest].iPriority)
+			iBest = i;
 		}
+
+	if (iBest != -1)
+		{
+		m_Tasks[iBest].iStatus = statusProcessing;
+		*retTask = m_Tasks[iBest];
+
+		m_iExecuting++;
+		if (retTask->bExclusive)
+			m_iExclusiveRunning++;
+
+		pWorker->SetTask(retTask->dwID);
+		}
+
+	//	Reset the work event if there is nothing left for other workers
+
+	UpdateWorkAvailable();
+
+	return (iBest != -1);
+	}
+
+void CBackgroundProcessor::FinishTask (const STask &Task)
+
+//	FinishTask
+//
+//	Called by a worker when it is done executing a task.
+
+	{
+	CSmartLock Lock(m_cs);
+	int i;
+
+	m_iExecuting--;
+	if (Task.bExclusive)
+		m_iExclusiveRunning--;
+
+	//	If there are no more tasks, then let the listeners know
+
+	bool bTasksLeft = (m_iExecuting > 0);
+	for (i = 0; i < m_Tasks.GetCount() && !bTasksLeft; i++)
+		if (m_Tasks[i].iStatus == statusReady)
+			bTasksLeft = true;
+
+	if (!bTasksLeft)
+		PostOnAllTasksComplete();
+
+	//	We may have unblocked an exclusive task
+
+	UpdateWorkAvailable();
 	}
 
 ALERROR CBackgroundProcessor::GetLastResult (CString *retsResult)
@@ -66,38 +227,122 @@ int CBackgroundProcessor::GetProgress (CString *retsActivity)
 
 //	GetProgress
 //
-//	Returns the current progress status of the processor
+//	Returns the current progress status of the processor. If more than one task
+//	is running we return the progress of the highest priority one. We return -1
+//	if no tasks are running.
+//
+//	NOTE: We only look at tasks that a worker is actually executing. Tasks stay
+//	in m_Tasks (with statusProcessing) until the UI thread handles their
+//	completion, long after the worker has moved on.
 
 	{
 	CSmartLock Lock(m_cs);
+	int i, j;
 
-	if (!m_bExecuting)
+	if (m_iExecuting == 0)
 		{
 		if (retsActivity)
 			*retsActivity = NULL_STR;
 		return -1;
 		}
 
+	CWorker *pBest = NULL;
+	int iBestPriority = 0;
+	for (i = 0; i < m_Workers.GetCount(); i++)
+		{
+		CWorker *pWorker = m_Workers[i];
+		if (!pWorker->IsExecuting())
+			continue;
+
+		//	If the task is not in the list then it was removed by StopAll (but
+		//	it is still running). We treat it as the lowest priority.
+
+		int iPriority = priorityLow - 1;
+		for (j = 0; j < m_Tasks.GetCount(); j++)
+			if (m_Tasks[j].dwID == pWorker->GetTaskID())
+				{
+				iPriority = m_Tasks[j].iPriority;
+				break;
+				}
+
+		if (pBest == NULL || iPriority > iBestPriority)
+			{
+			pBest = pWorker;
+			iBestPriority = iPriority;
+			}
+		}
+
+	if (pBest)
+		return pBest->GetProgress(retsActivity);
+
+	//	If we get this far, then a worker has just finished its task but has
+	//	not yet told us. Fall back to the last progress set on the processor.
+
 	if (retsActivity)
 		*retsActivity = m_sCurActivity;
 
 	return m_iPercentDone;
 	}
 
-ALERROR CBackgroundProcessor::Init (HWND hWnd, DWORD dwID)
+int CBackgroundProcessor::GetTaskProgress (DWORD dwID, CString *retsActivity)
+
+//	GetTaskProgress
+//
+//	Returns the progress of the given task. We return -1 if the task is not
+//	running (either because it has not started or because it is done).
+
+	{
+	CSmartLock Lock(m_cs);
+	int i;
+
+	for (i = 0; i < m_Workers.GetCount(); i++)
+		if (m_Workers[i]->IsExecuting() && m_Workers[i]->GetTaskID() == dwID)
+			return m_Workers[i]->GetProgress(retsActivity);
+
+	if (retsActivity)
+		*retsActivity = NULL_STR;
+
+	return -1;
+	}
+
+ALERROR CBackgroundProcessor::Init (HWND hWnd, DWORD dwID, int iWorkers)
 
 //	Init
 //
-//	Initialize the background thread
+//	Initialize the background threads. If iWorkers is 0, we create one worker
+//	per processor.
 
 	{
+	ALERROR error;
+	int i;
+
 	m_hWnd = hWnd;
 	m_dwID = dwID;
 
-	m_bExecuting = false;
+	if (iWorkers <= 0)
+		{
+		SYSTEM_INFO SysInfo;
+		::GetSystemInfo(&SysInfo);
+		iWorkers = Max(1, Min(MAX_WORKERS, (int)SysInfo.dwNumberOfProcessors));
+		}
+
+	m_iExecuting = 0;
+	m_iExclusiveRunning = 0;
 	m_hWorkAvailableEvent = ::CreateEvent(NULL, TRUE, FALSE, NULL);
 	m_hQuitEvent = ::CreateEvent(NULL, TRUE, FALSE, NULL);
-	m_hBackgroundThread = ::kernelCreateThread(Thread, this);
+
+	for (i = 0; i < iWorkers; i++)
+		{
+		CWorker *pWorker = new CWorker(*this);
+		if (error = pWorker->Init())
+			{
+			delete pWorker;
+			CleanUp();
+			return error;
+			}
+
+		m_Workers.Insert(pWorker);
+		}
 
 	return NOERROR;
 	}
@@ -173,7 +418,7 @@ void CBackgroundProcessor::OnTaskComplete (LPARAM pData)
 		delete pMsg;
 		}
 
-	//	Otherwise, this is a global message to all listeners who want to know 
+	//	Otherwise, this is a global message to all listeners who want to know
 	//	that there are no tasks left.
 
 	else
@@ -220,7 +465,9 @@ void CBackgroundProcessor::SetProgress (const CString &sActivity, int iPercentDo
 
 //	SetProgress
 //
-//	This may be called from inside the execution of any task
+//	Tasks normally report progress through their worker (which is the processor
+//	passed to OnExecute). This is used only if someone reports progress on the
+//	processor itself.
 
 	{
 	CSmartLock Lock(m_cs);
@@ -244,7 +491,7 @@ bool CBackgroundProcessor::RegisterOnAllTasksComplete (IHICommand *pListener, co
 
 //	RegisterOnAllTasksComplete
 //
-//	If there are tasks currently running then it registers the listener and 
+//	If there are tasks currently running then it registers the listener and
 //	calls it back (OnCommand) when all tasks have completed.
 //
 //	If no tasks are currently running then it returns FALSE.
@@ -252,9 +499,11 @@ bool CBackgroundProcessor::RegisterOnAllTasksComplete (IHICommand *pListener, co
 	{
 	CSmartLock Lock(m_cs);
 
-	//	If there is no work available then we're done
+	//	If there is no work then we're done. NOTE: Tasks stay in the array
+	//	until the UI thread has processed their completion, so if we find a
+	//	task here the all-tasks-complete message is still to come.
 
-	if (::WaitForSingleObject(m_hWorkAvailableEvent, 0) == WAIT_TIMEOUT)
+	if (m_Tasks.GetCount() == 0 && m_iExecuting == 0)
 		return false;
 
 	//	Add this to the global listeners table
@@ -272,7 +521,7 @@ void CBackgroundProcessor::StopAll()
 
 //	StopAll
 //
-//	Stop the background thread
+//	Stop the background threads
 
 	{
 	int i;
@@ -291,24 +540,153 @@ void CBackgroundProcessor::StopAll()
 	//	deleted when the OnTaskComplete message arrives.
 
 	m_Tasks.DeleteAll();
-	m_cs.Unlock();
 
-	//	Wait until we're done processing the current task
+	//	Signal all running tasks to stop
 
 	::SetEvent(m_hQuitEvent);
-	while (m_bExecuting)
+	for (i = 0; i < m_Workers.GetCount(); i++)
+		m_Workers[i]->Cancel();
+
+	m_cs.Unlock();
+
+	//	Wait until we're done processing the current tasks
+
+	while (m_iExecuting > 0)
 		::Sleep(1000);
 	}
 
-DWORD WINAPI CBackgroundProcessor::Thread (LPVOID pData)
+void CBackgroundProcessor::UpdateWorkAvailable (void)
 
-//	Thread
+//	UpdateWorkAvailable
 //
-//	This is the background thread
+//	Sets the work available event if there is at least one task that a worker
+//	could pick up right now. Otherwise we reset it so that workers don't spin.
+//	We must be called inside the lock.
 
 	{
 	int i;
-	CBackgroundProcessor *pThis = (CBackgroundProcessor *)pData;
+
+	for (i = 0; i < m_Tasks.GetCount(); i++)
+		if (m_Tasks[i].iStatus == statusReady
+				&& (!m_Tasks[i].bExclusive || m_iExclusiveRunning == 0))
+			{
+			::SetEvent(m_hWorkAvailableEvent);
+			return;
+			}
+
+	::ResetEvent(m_hWorkAvailableEvent);
+	}
+
+//	CWorker --------------------------------------------------------------------
+
+void CBackgroundProcessor::CWorker::CleanUp (void)
+
+//	CleanUp
+//
+//	Wait for the thread to terminate. The caller must have already signalled
+//	the quit event.
+
+	{
+	if (m_hThread != INVALID_HANDLE_VALUE)
+		{
+		::WaitForSingleObject(m_hThread, INFINITE);
+		::CloseHandle(m_hThread);
+		m_hThread = INVALID_HANDLE_VALUE;
+		}
+
+	if (m_hCancelEvent != INVALID_HANDLE_VALUE)
+		{
+		::CloseHandle(m_hCancelEvent);
+		m_hCancelEvent = INVALID_HANDLE_VALUE;
+		}
+	}
+
+int CBackgroundProcessor::CWorker::GetProgress (CString *retsActivity) const
+
+//	GetProgress
+//
+//	Returns the progress of the current task. The caller must hold the
+//	processor lock.
+
+	{
+	if (retsActivity)
+		*retsActivity = m_sCurActivity;
+
+	return m_iPercentDone;
+	}
+
+ALERROR CBackgroundProcessor::CWorker::Init (void)
+
+//	Init
+//
+//	Start the worker thread
+
+	{
+	m_hCancelEvent = ::CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (m_hCancelEvent == NULL)
+		{
+		m_hCancelEvent = INVALID_HANDLE_VALUE;
+		return ERR_FAIL;
+		}
+
+	m_hThread = ::kernelCreateThread(Thread, this);
+	if (m_hThread == NULL)
+		{
+		m_hThread = INVALID_HANDLE_VALUE;
+		return ERR_FAIL;
+		}
+
+	return NOERROR;
+	}
+
+void CBackgroundProcessor::CWorker::SetProgress (const CString &sActivity, int iPercentDone)
+
+//	SetProgress
+//
+//	This may be called from inside the execution of our task
+
+	{
+	CSmartLock Lock(m_Processor.m_cs);
+	m_iPercentDone = iPercentDone;
+	m_sCurActivity = sActivity;
+	}
+
+void CBackgroundProcessor::CWorker::SetTask (DWORD dwID)
+
+//	SetTask
+//
+//	Sets the task that we're running (0 = no task). The caller must hold the
+//	processor lock.
+
+	{
+	m_dwTaskID = dwID;
+
+	if (dwID)
+		{
+		m_iPercentDone = 0;
+		m_sCurActivity = CONSTLIT("Running");
+
+		//	Clear any cancellation from a previous task (we're under the lock,
+		//	so we can't be racing with StopAll).
+
+		::ResetEvent(m_hCancelEvent);
+		}
+	else
+		{
+		m_iPercentDone = -1;
+		m_sCurActivity = NULL_STR;
+		}
+	}
+
+DWORD WINAPI CBackgroundProcessor::CWorker::Thread (LPVOID pData)
+
+//	Thread
+//
+//	This is the worker thread
+
+	{
+	CWorker *pThis = (CWorker *)pData;
+	CBackgroundProcessor &Processor = pThis->m_Processor;
 
 	while (true)
 		{
@@ -318,8 +696,8 @@ DWORD WINAPI CBackgroundProcessor::Thread (LPVOID pData)
 		//	Wait for something to happen
 
 		HANDLE Events[2];
-		Events[0] = pThis->m_hQuitEvent;
-		Events[1] = pThis->m_hWorkAvailableEvent;
+		Events[0] = Processor.m_hQuitEvent;
+		Events[1] = Processor.m_hWorkAvailableEvent;
 		DWORD dwResult = ::WaitForMultipleObjects(2, Events, FALSE, INFINITE);
 
 		//	Do the work
@@ -329,67 +707,38 @@ DWORD WINAPI CBackgroundProcessor::Thread (LPVOID pData)
 
 		else if (dwResult == WORK_EVENT)
 			{
-			//	Pull a task out of the array
-
-			pThis->m_cs.Lock();
-			IHITask *pTask = NULL;
+			//	Pull a task out of the queue. If another worker beat us to it,
+			//	then go back to waiting.
 
-			for (i = 0; i < pThis->m_Tasks.GetCount(); i++)
-				if (pThis->m_Tasks[i].iStatus == statusReady)
-					{
-					pTask = pThis->m_Tasks[i].pTask;
-					pThis->m_Tasks[i].iStatus = statusProcessing;
-					break;
-					}
-
-			pThis->m_cs.Unlock();
+			STask Task;
+			if (!Processor.DequeueTask(pThis, &Task))
+				continue;
 
 			//	Do the task
 
-			if (pTask)
+			CString sResult;
+			ALERROR error;
+			try
+				{
+				error = Task.pTask->HIExecute(pThis, &sResult);
+				}
+			catch (...)
 				{
-				pThis->m_bExecuting = true;
-				pThis->SetProgress(CONSTLIT("Running"), 0);
-
-				CString sResult;
-				ALERROR error;
-				try
-					{
-					error = pTask->HIExecute(pThis, &sResult);
-					}
-				catch (...)
-					{
-					sResult = CONSTLIT("Crash executing task.");
-					error = ERR_FAIL;
-					}
-
-				pThis->SetProgress(NULL_STR, -1);
-				pThis->SetResult(error, (sResult.IsBlank() ? CONSTLIT("Done") : sResult));
-				pThis->m_bExecuting = false;
-
-				//	When we're done, call m_HI so that it can do
-				//	a notification on the UI thread.
-
-				pThis->PostOnTaskComplete(pTask);
+				sResult = CONSTLIT("Crash executing task.");
+				error = ERR_FAIL;
 				}
 
-			//	If there are no more tasks, reset
+			Processor.SetResult(error, (sResult.IsBlank() ? CONSTLIT("Done") : sResult));
 
-			pThis->m_cs.Lock();
-			bool bTasksLeft = false;
-			for (i = 0; i < pThis->m_Tasks.GetCount(); i++)
-				if (pThis->m_Tasks[i].iStatus == statusReady)
-					{
-					bTasksLeft = true;
-					break;
-					}
+			Processor.m_cs.Lock();
+			pThis->SetTask(0);
+			Processor.m_cs.Unlock();
 
-			if (!bTasksLeft)
-				{
-				pThis->PostOnAllTasksComplete();
-				::ResetEvent(pThis->m_hWorkAvailableEvent);
-				}
-			pThis->m_cs.Unlock();
+			//	When we're done, call m_HI so that it can do
+			//	a notification on the UI thread.
+
+			Processor.PostOnTaskComplete(Task.pTask);
+			Processor.FinishTask(Task);
 			}
 		}
 	}
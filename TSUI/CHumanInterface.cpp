@@ -42,6 +42,8 @@ void CHumanInterface::AddBackgroundTask (IHITask *pTask, DWORD dwFlags, IHIComma
 	{
 	if (dwFlags & FLAG_LOW_PRIORITY)
 		m_BackgroundLowPriority.AddTask(pTask, pListener, sCmd);
+	else if (dwFlags & FLAG_HIGH_PRIORITY)
+		m_Background.AddTask(pTask, pListener, sCmd, CBackgroundProcessor::priorityHigh);
 	else
 		m_Background.AddTask(pTask, pListener, sCmd);
 	}
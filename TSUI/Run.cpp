@@ -418,7 +418,8 @@ bool CHumanInterface::WMCreate (HWND hWnd, CString *retsError)
 	if (m_ScreenMgr.Init(ScreenOptions, retsError) != NOERROR)
 		return false;
 
-	//	Initialize the background processors
+	//	Initialize the background processors. The low-priority processor only
+	//	gets a single worker so that it never competes with foreground work.
 
 	if (m_Background.Init(m_hWnd, ID_BACKGROUND_PROCESSOR) != NOERROR)
 		{
@@ -426,7 +427,7 @@ bool CHumanInterface::WMCreate (HWND hWnd, CString *retsError)
 		return false;
 		}
 
-	if (m_BackgroundLowPriority.Init(m_hWnd, ID_LOW_PRIORITY_BACKGROUND_PROCESSOR) != NOERROR)
+	if (m_BackgroundLowPriority.Init(m_hWnd, ID_LOW_PRIORITY_BACKGROUND_PROCESSOR, 1) != NOERROR)
 		{
 		if (retsError) *retsError = CONSTLIT("Unable to initialize background processor.");
 		return false;